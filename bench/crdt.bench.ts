@@ -0,0 +1,49 @@
+import { diffCRDT, mergeGraph, mergeGraphInPlace } from '../src/crdt';
+import { BenchSuite } from './harness';
+import { cloneGraph, manySouls, wideNode } from './fixtures';
+
+const MACHINE_STATE = 10;
+
+describe('Bench: CRDT', () =>
+{
+    const suite    = new BenchSuite('crdt');
+    const existing = { wide: wideNode('wide', 1000, 1) };
+    const newer    = { wide: wideNode('wide', 1000, 2) };
+    const same     = cloneGraph(existing);
+    const souls    = manySouls('souls', 1000, 2);
+
+    afterAll(() => suite.write());
+
+    it('diffCRDT wide node, all fields newer', async () =>
+    {
+        await suite.measure('diffCRDT wide node newer', () => diffCRDT(newer, existing, { machineState: MACHINE_STATE }));
+    });
+
+    it('diffCRDT wide node, equal states', async () =>
+    {
+        await suite.measure('diffCRDT wide node equal', () => diffCRDT(same, existing, { machineState: MACHINE_STATE }));
+    });
+
+    it('diffCRDT many souls against empty graph', async () =>
+    {
+        await suite.measure('diffCRDT many souls', () => diffCRDT(souls, {}, { machineState: MACHINE_STATE }));
+    });
+
+    it('diffCRDT + mergeGraph', async () =>
+    {
+        await suite.measure(
+            'diffCRDT + mergeGraph wide node',
+            graph => mergeGraph(graph, diffCRDT(newer, graph, { machineState: MACHINE_STATE }), 'mutable'),
+            () => cloneGraph(existing),
+        );
+    });
+
+    it('mergeGraphInPlace', async () =>
+    {
+        await suite.measure(
+            'mergeGraphInPlace wide node',
+            graph => mergeGraphInPlace(graph, newer, { machineState: MACHINE_STATE }),
+            () => cloneGraph(existing),
+        );
+    });
+});
@@ -0,0 +1,92 @@
+import { TGGraphData, TGNode } from '../src/types';
+
+/**
+ * Seeded PRNG (mulberry32), so every run benches the same graphs
+ */
+export function createRandom(seed = 42): () => number
+{
+    let state = seed >>> 0;
+
+    return () =>
+    {
+        state     = (state + 0x6d2b79f5) >>> 0;
+        let t     = state;
+        t         = Math.imul(t ^ (t >>> 15), t | 1);
+        t        ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+        return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+    };
+}
+
+export function randomString(random: () => number, length: number): string
+{
+    let value = '';
+    for (let i = 0; i < length; i++)
+    {
+        value += String.fromCharCode(97 + Math.floor(random() * 26));
+    }
+    return value;
+}
+
+/**
+ * Node with many scalar fields
+ */
+export function wideNode(soul: string, fields: number, state = 1, random = createRandom()): TGNode
+{
+    const node: TGNode = { _: { '#': soul, '>': {} } };
+
+    for (let i = 0; i < fields; i++)
+    {
+        const key        = `field${i}`;
+        node[key]        = i % 2 ? random() * 1000 : randomString(random, 16);
+        node._['>'][key] = state;
+    }
+
+    return node;
+}
+
+/**
+ * Chain of nodes linked by `next`, souls are `root/next/next/...`
+ */
+export function deepPath(root: string, depth: number, state = 1): TGGraphData
+{
+    const graph: TGGraphData = {};
+    let soul                 = root;
+
+    for (let i = 0; i < depth; i++)
+    {
+        const next  = `${soul}/next`;
+        graph[soul] = {
+            _    : { '#': soul, '>': { level: state, next: state } },
+            level: i,
+            next : { '#': next },
+        };
+        soul        = next;
+    }
+
+    return graph;
+}
+
+/**
+ * Many small nodes sharing a soul prefix, souls are in random order
+ */
+export function manySouls(prefix: string, count: number, state = 1, random = createRandom()): TGGraphData
+{
+    const graph: TGGraphData = {};
+
+    for (let i = 0; i < count; i++)
+    {
+        const soul  = `${prefix}/${randomString(random, 12)}`;
+        graph[soul] = {
+            _    : { '#': soul, '>': { value: state, index: state } },
+            value: randomString(random, 32),
+            index: i,
+        };
+    }
+
+    return graph;
+}
+
+export function cloneGraph(graph: TGGraphData): TGGraphData
+{
+    return JSON.parse(JSON.stringify(graph));
+}
@@ -0,0 +1,31 @@
+import { AsyncStreamEmitter } from 'topgun-async-stream-emitter';
+import { TGGraph } from '../src/client/graph/graph';
+import { diffCRDT } from '../src/crdt';
+import { BenchSuite } from './harness';
+import { manySouls } from './fixtures';
+
+describe('Bench: Graph', () =>
+{
+    const suite = new BenchSuite('graph');
+
+    afterAll(() => suite.write());
+
+    it('receiveGraphData with active queries', async () =>
+    {
+        const graph = new TGGraph(new AsyncStreamEmitter());
+        const souls = Object.keys(manySouls('chat', 1000));
+        const noop  = () => undefined;
+        let state   = 1;
+
+        graph.use(diffCRDT);
+        souls.forEach((soul, i) => graph.queryMany({ '#': soul }, noop, `soul${i}`));
+        ['a', 'b', 'c', 'd', 'e'].forEach(prefix => graph.queryMany({ '#': 'chat', '.': { '*': prefix } }, noop, prefix));
+
+        await suite.measure(
+            'receiveGraphData 1000 souls, 1005 queries',
+            data => graph.receiveGraphData(data),
+            () => manySouls('chat', 1000, state++),
+            { iterations: 50, warmup: 5, opsPerIteration: 1000 },
+        );
+    });
+});
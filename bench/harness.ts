@@ -0,0 +1,132 @@
+import { mkdirSync, writeFileSync } from 'fs';
+import { join } from 'path';
+
+export interface BenchOptions
+{
+    /** Measured iterations, 100 by default */
+    iterations?: number;
+    /** Iterations run before measuring, 10 by default */
+    warmup?: number;
+    /** Operations performed by one iteration, used for throughput */
+    opsPerIteration?: number;
+}
+
+export interface BenchResult
+{
+    name: string;
+    iterations: number;
+    opsPerIteration: number;
+    totalMs: number;
+    opsPerSec: number;
+    meanMs: number;
+    p50Ms: number;
+    p99Ms: number;
+    maxMs: number;
+}
+
+/**
+ * Collects the results of one bench suite and writes them as JSON
+ *
+ * Output goes to `bench/results/<suite>.json`, or to TOPGUN_BENCH_OUTPUT when set
+ */
+export class BenchSuite
+{
+    readonly results: BenchResult[];
+
+    /**
+     * Constructor
+     */
+    constructor(readonly suite: string)
+    {
+        this.results = [];
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Time fn, with an optional setup that runs before each iteration and is not measured
+     */
+    async measure<T>(
+        name: string,
+        fn: (input: T) => unknown,
+        setup?: () => T|Promise<T>,
+        options?: BenchOptions,
+    ): Promise<BenchResult>
+    {
+        const { iterations = 100, warmup = 10, opsPerIteration = 1 } = options || {};
+        const samples: number[]                                    = [];
+
+        for (let i = 0; i < warmup + iterations; i++)
+        {
+            const input = setup ? await setup() : undefined;
+            const start = process.hrtime.bigint();
+            await fn(input as T);
+            const ms    = Number(process.hrtime.bigint() - start) / 1e6;
+
+            if (i >= warmup)
+            {
+                samples.push(ms);
+            }
+        }
+
+        return this.record(name, samples, opsPerIteration);
+    }
+
+    /**
+     * Record externally measured samples in ms
+     */
+    record(name: string, samples: number[], opsPerIteration = 1): BenchResult
+    {
+        const sorted  = [...samples].sort((a, b) => a - b);
+        const totalMs = sorted.reduce((sum, ms) => sum + ms, 0);
+        const result  = {
+            name,
+            iterations: sorted.length,
+            opsPerIteration,
+            totalMs,
+            opsPerSec : totalMs > 0 ? (sorted.length * opsPerIteration * 1000) / totalMs : Infinity,
+            meanMs    : totalMs / sorted.length,
+            p50Ms     : percentile(sorted, 0.5),
+            p99Ms     : percentile(sorted, 0.99),
+            maxMs     : sorted[sorted.length - 1],
+        };
+
+        this.results.push(result);
+        return result;
+    }
+
+    write(): void
+    {
+        const dir = process.env.TOPGUN_BENCH_OUTPUT || join(__dirname, 'results');
+
+        mkdirSync(dir, { recursive: true });
+        writeFileSync(
+            join(dir, `${this.suite}.json`),
+            JSON.stringify({
+                suite  : this.suite,
+                node   : process.version,
+                date   : new Date().toISOString(),
+                results: this.results,
+            }, null, 4),
+        );
+
+        console.table(this.results.map(({ name, opsPerSec, meanMs, p50Ms, p99Ms }) => ({
+            name,
+            'ops/s'  : Math.round(opsPerSec),
+            'mean ms': meanMs.toFixed(3),
+            'p50 ms' : p50Ms.toFixed(3),
+            'p99 ms' : p99Ms.toFixed(3),
+        })));
+    }
+}
+
+function percentile(sorted: number[], p: number): number
+{
+    if (!sorted.length)
+    {
+        return 0;
+    }
+    return sorted[Math.min(sorted.length - 1, Math.floor(p * sorted.length))];
+}
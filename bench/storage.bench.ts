@@ -0,0 +1,77 @@
+import { createGraphAdapter } from '../src/storage';
+import { MemoryStorage } from '../src/memory-adapter';
+import { TGGraphAdapter } from '../src/types';
+import { BenchSuite } from './harness';
+import { cloneGraph, deepPath, manySouls, wideNode } from './fixtures';
+
+describe('Bench: Storage', () =>
+{
+    const suite = new BenchSuite('storage');
+    const souls = manySouls('chat', 10000);
+    const keys  = Object.keys(souls);
+
+    afterAll(() => suite.write());
+
+    it('adapter put many souls', async () =>
+    {
+        await suite.measure(
+            'adapter put 1000 souls',
+            adapter => adapter.put(manySouls('chat', 1000)),
+            () => createGraphAdapter(new MemoryStorage()),
+            { iterations: 20, warmup: 2, opsPerIteration: 1000 },
+        );
+    });
+
+    it('adapter put wide node', async () =>
+    {
+        let state = 1;
+        const adapter = createGraphAdapter(new MemoryStorage());
+
+        await suite.measure(
+            'adapter put wide node',
+            graph => adapter.put(graph),
+            () => ({ wide: wideNode('wide', 1000, state++) }),
+        );
+    });
+
+    it('adapter put deep path', async () =>
+    {
+        await suite.measure(
+            'adapter put deep path',
+            adapter => adapter.put(deepPath('root', 200)),
+            () => createGraphAdapter(new MemoryStorage()),
+            { opsPerIteration: 200 },
+        );
+    });
+
+    describe('with 10000 souls', () =>
+    {
+        let adapter: TGGraphAdapter;
+        let storage: MemoryStorage;
+
+        beforeAll(async () =>
+        {
+            storage = new MemoryStorage();
+            adapter = createGraphAdapter(storage);
+            await adapter.put(cloneGraph(souls));
+        });
+
+        it('adapter get', async () =>
+        {
+            let i = 0;
+            await suite.measure(
+                'adapter get soul',
+                () => adapter.get({ '#': keys[i++ % keys.length] }),
+                undefined,
+                { iterations: 10000, warmup: 100 },
+            );
+        });
+
+        it('memory storage list', async () =>
+        {
+            await suite.measure('list prefix limit 50', () => storage.list({ prefix: 'chat/m', limit: 50 }), undefined, { iterations: 1000 });
+            await suite.measure('list start/end reverse', () => storage.list({ start: 'chat/c', end: 'chat/d', reverse: true }), undefined, { iterations: 1000 });
+            await suite.measure('list all', () => storage.list({}), undefined, { iterations: 20 });
+        });
+    });
+});
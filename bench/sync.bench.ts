@@ -0,0 +1,93 @@
+import { TGClient } from '../src/client';
+import { TGServer } from '../src/server';
+import { BenchSuite } from './harness';
+import { wideNode } from './fixtures';
+
+const PORT_NUMBER = Number(process.env.TOPGUN_BENCH_PORT) || 3470;
+const CLIENTS     = Number(process.env.TOPGUN_BENCH_CLIENTS) || 20;
+const ROUNDS      = Number(process.env.TOPGUN_BENCH_ROUNDS) || 50;
+
+function createClient(): TGClient
+{
+    return new TGClient({
+        peers: [{
+            hostname: '127.0.0.1',
+            port    : PORT_NUMBER,
+        }],
+    });
+}
+
+describe('Bench: Sync', () =>
+{
+    const suite = new BenchSuite('sync');
+    let server: TGServer;
+    let writer: TGClient;
+    let readers: TGClient[];
+
+    beforeAll(async () =>
+    {
+        server  = new TGServer({ port: PORT_NUMBER });
+        writer  = createClient();
+        readers = Array.from({ length: CLIENTS }, createClient);
+
+        await server.waitForReady();
+        await Promise.all([writer, ...readers].map(client => client.waitForConnect()));
+    });
+    afterAll(async () =>
+    {
+        suite.write();
+        await Promise.all([writer, ...readers].map(client => client.disconnect()));
+        await server.close();
+    });
+
+    it(`fan-out of a 100 field put to ${CLIENTS} clients`, async () =>
+    {
+        const samples: number[] = [];
+        const seen              = new Map<number, number>();
+        let onRound: () => void;
+
+        readers.forEach(reader =>
+        {
+            reader.get('bench').on<{round: number}>((data) =>
+            {
+                const count = (seen.get(data.round) || 0) + 1;
+                seen.set(data.round, count);
+
+                if (count === CLIENTS && onRound)
+                {
+                    onRound();
+                }
+            });
+        });
+
+        for (let round = 1; round <= ROUNDS; round++)
+        {
+            const node = wideNode('bench', 100, round);
+            delete node._;
+
+            const delivered = new Promise<void>(resolve => onRound = resolve);
+            const start     = process.hrtime.bigint();
+
+            writer.get('bench').put({ ...node, round });
+            await delivered;
+
+            samples.push(Number(process.hrtime.bigint() - start) / 1e6);
+        }
+
+        suite.record(`put to ${CLIENTS} subscribers`, samples);
+    });
+
+    it('round trip put acknowledgement', async () =>
+    {
+        const samples: number[] = [];
+
+        for (let i = 0; i < ROUNDS; i++)
+        {
+            const start = process.hrtime.bigint();
+            await writer.get('ack').get(`item${i}`).put({ i });
+            samples.push(Number(process.hrtime.bigint() - start) / 1e6);
+        }
+
+        suite.record('put ack round trip', samples);
+    });
+});
@@ -1,8 +1,10 @@
 import { TGSocketClientOptions } from 'topgun-socket/client';
 import { TGGraphConnector } from './transports/graph-connector';
+import { TGWebSocketConnectorOptions } from './transports/web-socket-graph-connector';
 import { TGGraphAdapterOptions, TGSupportedStorage } from '../types';
 import { localStorageAdapter } from '../utils/local-storage';
 import { MAX_KEY_SIZE, MAX_VALUE_SIZE } from '../storage';
+import { IndexedDBStorageOptions } from '../indexeddb/indexeddb-storage';
 
 export type TGClientPeerOptions = string|TGSocketClientOptions;
 
@@ -10,8 +12,15 @@ export interface TGClientOptions extends TGGraphAdapterOptions
 {
     peers?: TGClientPeerOptions[];
     connectors?: TGGraphConnector[];
+    /** Backpressure, offline buffering and multiplexing options of the peer connectors */
+    peerConnectorOptions?: TGWebSocketConnectorOptions;
     localStorage?: boolean;
     localStorageKey?: string;
+    localStorageOptions?: IndexedDBStorageOptions;
+    /** Serialized size in bytes of the in-memory graph, nodes no query listens to are evicted beyond it. 0 for no limit */
+    graphMemoryBudget?: number;
+    /** Write evicted nodes to local storage, so they are read back from it instead of the peers */
+    spillEvictedNodes?: boolean;
     sessionStorage?: TGSupportedStorage|boolean;
     sessionStorageKey?: string;
     passwordMinLength?: number;
@@ -22,8 +31,12 @@ export interface TGClientOptions extends TGGraphAdapterOptions
 export const DEFAULT_OPTIONS: Required<TGClientOptions> = {
     peers                    : [],
     connectors               : [],
+    peerConnectorOptions     : {},
     localStorage             : false,
     localStorageKey          : 'topgun-nodes',
+    localStorageOptions      : {},
+    graphMemoryBudget        : 0,
+    spillEvictedNodes        : false,
     sessionStorage           : localStorageAdapter,
     sessionStorageKey        : 'topgun-session',
     passwordMinLength        : 8,
@@ -1,12 +1,11 @@
-import { isObject, isString } from 'topgun-typed';
+import { isNumber, isObject, isString } from 'topgun-typed';
 import { AsyncStreamEmitter } from 'topgun-async-stream-emitter';
 import { diffCRDT } from '../crdt';
 import { TGLink } from './link';
 import { TGGraph } from './graph/graph';
 import { TGGraphConnector } from './transports/graph-connector';
 import { DEFAULT_OPTIONS, TGClientOptions, TGClientPeerOptions } from './client-options';
-import { createConnector } from './transports/web-socket-graph-connector';
-import { TGSocketClientOptions } from 'topgun-socket/client';
+import { createPeerConnectors } from './transports/web-socket-graph-connector';
 import { TGUserApi } from './user-api';
 import { pubFromSoul, unpackGraph } from '../sea';
 import { TGIndexedDBConnector } from '../indexeddb/indexeddb-connector';
@@ -100,7 +99,17 @@ export class TGClient extends AsyncStreamEmitter<any>
         }
         if (options.localStorage)
         {
-            this.useConnector(new TGIndexedDBConnector(options.localStorageKey, options));
+            const connector = new TGIndexedDBConnector(options.localStorageKey, options, options.localStorageOptions);
+
+            this.useConnector(connector);
+            if (this.options.spillEvictedNodes)
+            {
+                this.graph.opt({ spillTo: connector });
+            }
+        }
+        if (isNumber(options.graphMemoryBudget))
+        {
+            this.graph.opt({ memoryBudget: options.graphMemoryBudget });
         }
         if (Array.isArray(options.connectors))
         {
@@ -156,6 +165,14 @@ export class TGClient extends AsyncStreamEmitter<any>
         return this.graph.connectors;
     }
 
+    /**
+     * Resolves once no connector is saturated, writers may await it to respect backpressure
+     */
+    async waitForDrain(): Promise<void>
+    {
+        await this.graph.waitForDrain();
+    }
+
     // -----------------------------------------------------------------------------------------------------
     // @ Private methods
     // -----------------------------------------------------------------------------------------------------
@@ -186,36 +203,10 @@ export class TGClient extends AsyncStreamEmitter<any>
     /**
      * Connect to peers via connector TopGunSocket
      */
-    private async handlePeers(peers: TGClientPeerOptions[]): Promise<void>
+    private handlePeers(peers: TGClientPeerOptions[]): void
     {
-        peers.forEach((peer: TGClientPeerOptions) =>
-        {
-            try
-            {
-                if (isString(peer))
-                {
-                    const url                            = new URL(peer);
-                    const options: TGSocketClientOptions = {
-                        hostname: url.hostname,
-                        secure  : url.protocol.includes('https'),
-                    };
-
-                    if (url.port.length > 0)
-                    {
-                        options.port = Number(url.port);
-                    }
-
-                    this.useConnector(createConnector(options));
-                }
-                else if (isObject(peer))
-                {
-                    this.useConnector(createConnector(peer));
-                }
-            }
-            catch (e)
-            {
-                console.error(e);
-            }
-        });
+        createPeerConnectors(peers, this.options.peerConnectorOptions).forEach(connector =>
+            this.useConnector(connector),
+        );
     }
 }
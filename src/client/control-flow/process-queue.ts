@@ -1,9 +1,13 @@
+import { isObject, isString } from 'topgun-typed';
 import { TGMessage } from '../../types';
 import { TGQueue } from './queue';
 import { TGMiddlewareSystem } from './middleware-system';
 
 type TGProcessDupesOption = 'process_dupes'|'dont_process_dupes';
 
+/** Number of processed items remembered by 'dont_process_dupes' */
+export const DEDUPE_WINDOW_SIZE = 10000;
+
 export class TGProcessQueue<T = TGMessage,
     U = any,
     V = any,
@@ -12,8 +16,10 @@ export class TGProcessQueue<T = TGMessage,
     isProcessing: boolean;
     readonly middleware: TGMiddlewareSystem<T, U, V>;
     readonly processDupes: TGProcessDupesOption;
+    readonly dedupeWindowSize: number;
 
-    protected alreadyProcessed: T[];
+    /** Recently processed message ids (or items without an id), oldest first */
+    protected alreadyProcessed: Set<unknown>;
 
     /**
      * Constructor
@@ -21,12 +27,14 @@ export class TGProcessQueue<T = TGMessage,
     constructor(
         name                               = 'ProcessQueue',
         processDupes: TGProcessDupesOption = 'process_dupes',
+        dedupeWindowSize                   = DEDUPE_WINDOW_SIZE,
     )
     {
         super(name);
-        this.alreadyProcessed = [];
+        this.alreadyProcessed = new Set();
         this.isProcessing     = false;
         this.processDupes     = processDupes;
+        this.dedupeWindowSize = dedupeWindowSize;
         this.middleware       = new TGMiddlewareSystem<T, U, V>(`${name}.middleware`);
     }
 
@@ -36,7 +44,7 @@ export class TGProcessQueue<T = TGMessage,
 
     has(item: T): boolean
     {
-        return super.has(item) || this.alreadyProcessed.indexOf(item) !== -1;
+        return super.has(item) || this.alreadyProcessed.has(dedupeKey(item));
     }
 
     async processNext(b?: U, c?: V): Promise<void>
@@ -53,7 +61,7 @@ export class TGProcessQueue<T = TGMessage,
 
         if (processedItem && this.processDupes === 'dont_process_dupes')
         {
-            this.alreadyProcessed.push(processedItem);
+            this._markProcessed(processedItem);
         }
 
         if (item)
@@ -96,4 +104,29 @@ export class TGProcessQueue<T = TGMessage,
         this.emit('emptied', true);
         this.isProcessing = false;
     }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    private _markProcessed(item: T): void
+    {
+        const key = dedupeKey(item);
+
+        this.alreadyProcessed.delete(key);
+        this.alreadyProcessed.add(key);
+
+        if (this.alreadyProcessed.size > this.dedupeWindowSize)
+        {
+            this.alreadyProcessed.delete(this.alreadyProcessed.values().next().value);
+        }
+    }
+}
+
+/**
+ * Messages are deduplicated by their '#' id, other items by identity
+ */
+function dedupeKey(item: unknown): unknown
+{
+    return isObject(item) && isString(item['#']) ? item['#'] : item;
 }
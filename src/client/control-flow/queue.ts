@@ -1,10 +1,18 @@
 import { AsyncStreamEmitter } from 'topgun-async-stream-emitter';
 import { TGMessage } from '../../types';
 
+const INITIAL_CAPACITY = 16;
+
+/**
+ * FIFO queue of unique items, backed by a growable ring buffer
+ */
 export class TGQueue<T = TGMessage> extends AsyncStreamEmitter<any>
 {
     readonly name: string;
-    private _queue: T[];
+    private _buffer: (T|undefined)[];
+    private _head: number;
+    private _size: number;
+    private readonly _members: Map<T, number>;
 
     /**
      * Constructor
@@ -12,8 +20,11 @@ export class TGQueue<T = TGMessage> extends AsyncStreamEmitter<any>
     constructor(name = 'Queue')
     {
         super();
-        this.name   = name;
-        this._queue = [];
+        this.name     = name;
+        this._buffer  = new Array(INITIAL_CAPACITY);
+        this._head    = 0;
+        this._size    = 0;
+        this._members = new Map();
     }
 
     // -----------------------------------------------------------------------------------------------------
@@ -22,12 +33,12 @@ export class TGQueue<T = TGMessage> extends AsyncStreamEmitter<any>
 
     count(): number
     {
-        return this._queue.length;
+        return this._size;
     }
 
     has(item: T): boolean
     {
-        return this._queue.indexOf(item) !== -1;
+        return this._members.has(item);
     }
 
     enqueue(item: T): TGQueue<T>
@@ -37,24 +48,77 @@ export class TGQueue<T = TGMessage> extends AsyncStreamEmitter<any>
             return this;
         }
 
-        this._queue.splice(0, 0, item);
+        this._push(item);
         return this;
     }
 
     dequeue(): T|undefined
     {
-        return this._queue.pop();
+        if (!this._size)
+        {
+            return undefined;
+        }
+
+        const item               = this._buffer[this._head] as T;
+        this._buffer[this._head] = undefined;
+        this._head               = (this._head + 1) & (this._buffer.length - 1);
+        this._size--;
+
+        const count = this._members.get(item) as number;
+
+        if (count > 1)
+        {
+            this._members.set(item, count - 1);
+        }
+        else
+        {
+            this._members.delete(item);
+        }
+
+        return item;
     }
 
     enqueueMany(items: readonly T[]): TGQueue<T>
     {
         const filtered = items.filter(item => !this.has(item));
 
-        if (filtered.length)
+        for (const item of filtered)
         {
-            this._queue.splice(0, 0, ...filtered.slice().reverse());
+            this._push(item);
         }
 
         return this;
     }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    private _push(item: T): void
+    {
+        if (this._size === this._buffer.length)
+        {
+            this._grow();
+        }
+
+        this._buffer[(this._head + this._size) & (this._buffer.length - 1)] = item;
+        this._size++;
+        this._members.set(item, (this._members.get(item) || 0) + 1);
+    }
+
+    /**
+     * Double the capacity, keeping the capacity a power of two
+     */
+    private _grow(): void
+    {
+        const buffer = new Array<T|undefined>(this._buffer.length * 2);
+
+        for (let i = 0; i < this._size; i++)
+        {
+            buffer[i] = this._buffer[(this._head + i) & (this._buffer.length - 1)];
+        }
+
+        this._buffer = buffer;
+        this._head   = 0;
+    }
 }
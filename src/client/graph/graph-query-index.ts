@@ -0,0 +1,138 @@
+import { isString } from 'topgun-typed';
+import { TGNode } from '../../types';
+import { getNodeSoul } from '../../utils/node';
+import { TGGraphQuery } from './graph-query';
+
+interface TGQueryTrieNode
+{
+    readonly children: Map<string, TGQueryTrieNode>;
+    readonly queries: Set<TGGraphQuery>;
+}
+
+/**
+ * Index of active queries, so that an incoming node is only matched against queries that can contain it
+ *
+ * Queries are kept in a prefix trie keyed by their list prefix. Every query has one, a plain soul query
+ * lists the souls starting with its soul, so an incoming soul walks the trie once
+ */
+export class TGGraphQueryIndex
+{
+    private readonly _byPrefix: TGQueryTrieNode;
+
+    /**
+     * Constructor
+     */
+    constructor()
+    {
+        this._byPrefix = createTrieNode();
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    add(query: TGGraphQuery): TGGraphQueryIndex
+    {
+        const prefix = query.listOptions?.prefix || '';
+        let node     = this._byPrefix;
+
+        for (let i = 0; i < prefix.length; i++)
+        {
+            const char = prefix[i];
+            let child  = node.children.get(char);
+
+            if (!child)
+            {
+                child = createTrieNode();
+                node.children.set(char, child);
+            }
+            node = child;
+        }
+
+        node.queries.add(query);
+        return this;
+    }
+
+    remove(query: TGGraphQuery): TGGraphQueryIndex
+    {
+        const prefix = query.listOptions?.prefix || '';
+        const path   = [this._byPrefix];
+
+        for (let i = 0; i < prefix.length; i++)
+        {
+            const child = path[i].children.get(prefix[i]);
+
+            if (!child)
+            {
+                return this;
+            }
+            path.push(child);
+        }
+
+        path[prefix.length].queries.delete(query);
+
+        // Prune branches that no longer lead to any query
+        for (let i = prefix.length; i > 0; i--)
+        {
+            const node = path[i];
+
+            if (node.queries.size || node.children.size)
+            {
+                break;
+            }
+            path[i - 1].children.delete(prefix[i - 1]);
+        }
+
+        return this;
+    }
+
+    /**
+     * Whether any active query matches the node
+     */
+    hasMatch(node: TGNode|undefined): boolean
+    {
+        let matched = false;
+        this.forEachMatch(node, () => matched = true);
+        return matched;
+    }
+
+    /**
+     * Invoke callback for each active query that matches the node
+     */
+    forEachMatch(node: TGNode|undefined, cb: (query: TGGraphQuery) => void): void
+    {
+        const soul = getNodeSoul(node);
+
+        if (!isString(soul))
+        {
+            return;
+        }
+
+        let trieNode = this._byPrefix;
+
+        for (let i = 0; trieNode; i++)
+        {
+            trieNode.queries.forEach((query) =>
+            {
+                if (query.match(node))
+                {
+                    cb(query);
+                }
+            });
+
+            if (i >= soul.length)
+            {
+                break;
+            }
+            trieNode = trieNode.children.get(soul[i]);
+        }
+    }
+}
+
+function createTrieNode(): TGQueryTrieNode
+{
+    return {
+        children: new Map(),
+        queries : new Set(),
+    };
+}
@@ -3,7 +3,7 @@ import { TGGet, TGGraphData, TGMessage, TGNode, TGOnCb, TGOptionsGet } from '../
 import { TGGraph } from './graph';
 import { getNodeSoul } from '../../utils/node';
 import { StorageListOptions } from '../../storage';
-import { listFilterMatch, storageListOptionsFromGetOptions } from '../../storage/utils';
+import { createListFilter, storageListOptionsFromGetOptions } from '../../storage/utils';
 import { uuidv4 } from '../../utils/uuidv4';
 import { TGExchange } from '../../stream/exchange';
 import { TGStream } from '../../stream/stream';
@@ -15,6 +15,7 @@ export class TGGraphQuery extends TGExchange
 
     private _endCurQuery?: () => void;
     private readonly _listOptions: StorageListOptions|null;
+    private readonly _listFilter: (soul: string) => boolean;
     private readonly _graph: TGGraph;
     private readonly _updateGraph: (
         data: TGGraphData,
@@ -36,7 +37,17 @@ export class TGGraphQuery extends TGExchange
         this.queryString         = queryString;
         this._graph              = graph;
         this._updateGraph        = updateGraph;
-        this._listOptions        = storageListOptionsFromGetOptions(this.options)
+        this._listOptions        = storageListOptionsFromGetOptions(this.options);
+        this._listFilter         = createListFilter(this._listOptions);
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Accessors
+    // -----------------------------------------------------------------------------------------------------
+
+    get listOptions(): StorageListOptions|null
+    {
+        return this._listOptions;
     }
 
     // -----------------------------------------------------------------------------------------------------
@@ -62,13 +73,8 @@ export class TGGraphQuery extends TGExchange
     {
         const stream = this.subscribe();
 
-        (async () =>
-        {
-            for await (const packet of stream)
-            {
-                cb(packet);
-            }
-        })();
+        // Packets received while iterating the query index are delivered after it
+        stream.listen(packet => cb(packet), 'microtask');
 
         this._ask(msgId);
         return stream;
@@ -89,7 +95,7 @@ export class TGGraphQuery extends TGExchange
 
         if (this._listOptions)
         {
-            return listFilterMatch(this._listOptions, soul)
+            return this._listFilter(soul);
         }
 
         return soul === this.options['#'];
@@ -8,9 +8,12 @@ export function diffSets(
     updated: readonly string[],
 ): readonly [readonly string[], readonly string[]]
 {
+    const initialSet = new Set(initial);
+    const updatedSet = new Set(updated);
+
     return [
-        updated.filter(key => initial.indexOf(key) === -1),
-        initial.filter(key => updated.indexOf(key) === -1),
+        updated.filter(key => !initialSet.has(key)),
+        initial.filter(key => !updatedSet.has(key)),
     ];
 }
 
@@ -31,64 +34,83 @@ export function getNodesFromGraph(
     return filteredNodes;
 }
 
+/**
+ * Souls a path passes through, kept between resolutions of the path
+ */
+export interface TGPathCursor
+{
+    readonly souls: string[];
+    /** Index of the path key each soul is reached by */
+    readonly keyIndexes: number[];
+}
+
 export function getPathData(
     keys: string[],
     graph: TGGraphData,
 ): TGPathData
 {
-    const lastKey = keys[keys.length - 1];
+    return resolvePath(keys, graph, { souls: [], keyIndexes: [] });
+}
 
-    if (keys.length === 1)
+/**
+ * Resolve a path, reusing the souls of the cursor up to `fromSoul`.
+ * Nodes before that soul are unchanged since the last resolution, so the walk resumes from it
+ */
+export function resolvePath(
+    keys: string[],
+    graph: TGGraphData,
+    cursor: TGPathCursor,
+    fromSoul = 0,
+): TGPathData
+{
+    const { souls, keyIndexes } = cursor;
+
+    if (fromSoul <= 0 || fromSoul >= souls.length)
     {
-        return {
-            complete: lastKey in graph,
-            souls   : keys,
-            value   : graph[lastKey],
-        };
+        fromSoul      = 0;
+        souls[0]      = keys[0];
+        keyIndexes[0] = 0;
     }
 
-    const {
-        value: parentValue,
-        souls,
-        complete,
-    } = getPathData(keys.slice(0, keys.length - 1), graph);
+    souls.length      = fromSoul + 1;
+    keyIndexes.length = fromSoul + 1;
 
-    if (!isObject(parentValue))
+    let value: TGValue|undefined = graph[souls[fromSoul]];
+    let complete                 = souls[fromSoul] in graph;
+
+    for (let i = keyIndexes[fromSoul] + 1; i < keys.length; i++)
     {
-        return {
-            complete: complete || isDefined(parentValue),
-            souls,
-            value   : undefined,
-        };
-    }
+        if (!isObject(value))
+        {
+            complete = complete || isDefined(value);
+            value    = undefined;
+            break;
+        }
 
-    const value = (parentValue as TGNode)[lastKey];
+        value = (value as TGNode)[keys[i]];
 
-    if (!value)
-    {
-        return {
-            complete: true,
-            souls,
-            value,
-        };
-    }
+        if (!value)
+        {
+            complete = true;
+            continue;
+        }
 
-    const edgeSoul = value['#'];
+        const edgeSoul = value['#'];
 
-    if (edgeSoul)
-    {
-        return {
-            complete: edgeSoul in graph,
-            souls   : [...souls, edgeSoul],
-            value   : graph[edgeSoul],
-        };
+        if (edgeSoul)
+        {
+            souls.push(edgeSoul);
+            keyIndexes.push(i);
+            complete = edgeSoul in graph;
+            value    = graph[edgeSoul];
+        }
+        else
+        {
+            complete = true;
+        }
     }
 
-    return {
-        complete: true,
-        souls,
-        value,
-    };
+    return { complete, souls, value };
 }
 
 export function flattenGraphData(data: TGValue, fullPath: string[]): {
@@ -96,23 +118,27 @@ export function flattenGraphData(data: TGValue, fullPath: string[]): {
     soul: string
 }
 {
-    if (isObject(data))
-    {
-        const soul = fullPath.join('/');
-        return {
-            graphData: flattenGraphByPath(data, [soul]),
-            soul
-        };
-    }
-    else
-    {
-        const propertyName = fullPath.pop();
-        const soul         = fullPath.join('/');
-        return {
-            graphData: flattenGraphByPath({ [propertyName]: data }, [soul]),
-            soul
-        };
-    }
+    const { obj, pathArr, soul } = toFlattenRoot(data, fullPath);
+    return {
+        graphData: flattenGraphByPath(obj, pathArr),
+        soul
+    };
+}
+
+/**
+ * Like flattenGraphData, yields the nodes in chunks as soon as they are complete.
+ * A node is complete once all of its children are, so edges are written after their targets
+ */
+export function flattenGraphDataChunks(data: TGValue, fullPath: string[], chunkSize: number): {
+    chunks: Generator<TGGraphData>,
+    soul: string
+}
+{
+    const { obj, pathArr, soul } = toFlattenRoot(data, fullPath);
+    return {
+        chunks: flattenGraphByPathChunks(obj, pathArr, chunkSize),
+        soul
+    };
 }
 
 export function checkType(d: any, tmp?: any): string
@@ -130,6 +156,69 @@ export function flattenGraphByPath(
     pathArr: string[] = [],
     target            = {},
 ): TGGraphData
+{
+    const walk = walkGraphByPath(obj, pathArr, target);
+
+    while (!walk.next().done)
+    {
+        // Nodes are written to the target while walking
+    }
+    return target;
+}
+
+/**
+ * Flatten an object into nodes, yielding them in chunks of up to `chunkSize` complete nodes
+ */
+export function* flattenGraphByPathChunks(
+    obj: object,
+    pathArr: string[] = [],
+    chunkSize         = 1000,
+): Generator<TGGraphData>
+{
+    const target: TGGraphData = {};
+    let chunk: TGGraphData    = {};
+    let count                 = 0;
+
+    for (const soul of walkGraphByPath(obj, pathArr, target))
+    {
+        // Keys containing '/' can lead to a soul twice
+        chunk[soul] = chunk[soul] ? Object.assign(chunk[soul], target[soul]) : target[soul];
+        delete target[soul];
+
+        if (++count >= chunkSize)
+        {
+            yield chunk;
+            chunk = {};
+            count = 0;
+        }
+    }
+
+    if (count)
+    {
+        yield chunk;
+    }
+}
+
+interface TGFlattenFrame
+{
+    readonly obj: object;
+    readonly soul: string;
+    /** Keys leading to the object, for error messages */
+    readonly path: string;
+    readonly node: TGNode;
+    readonly keys: string[];
+    index: number;
+}
+
+/**
+ * Depth first walk with an explicit stack. Nodes are added to the target in the order they are reached,
+ * their soul is yielded once all of their children are complete
+ */
+function* walkGraphByPath(
+    obj: object,
+    pathArr: string[],
+    target: TGGraphData,
+): Generator<string>
 {
     if (!isSupportValue(obj))
     {
@@ -142,22 +231,23 @@ export function flattenGraphByPath(
         obj = set(pathArr, obj);
     }
 
-    const path = pathArr.join('/');
-    if (pathArr.length > 0 && !isObject(target[path]))
-    {
-        target[path] = {};
-    }
+    const stack: TGFlattenFrame[] = [
+        createFlattenFrame(obj, pathArr.join('/'), pathArr.join('.'), pathArr.length > 0, target),
+    ];
 
-    for (const k in obj)
+    while (stack.length)
     {
-        if (!obj.hasOwnProperty(k) || k === '_')
+        const frame = stack[stack.length - 1];
+
+        if (frame.index >= frame.keys.length)
         {
+            stack.pop();
+            yield frame.soul;
             continue;
         }
 
-        const value       = obj[k];
-        const pathArrFull = [...pathArr, k];
-        const pathFull    = pathArrFull.join('/');
+        const k     = frame.keys[frame.index++];
+        const value = frame.obj[k];
 
         if (!isSupportValue(value))
         {
@@ -165,20 +255,62 @@ export function flattenGraphByPath(
                 'Invalid data: ' +
                 checkType(value) +
                 ' at ' +
-                pathArrFull.join('.'),
+                frame.path + '.' + k,
             );
             continue;
         }
 
         if (isObject(value))
         {
-            target[path][k] = { '#': pathFull };
-            flattenGraphByPath(value, pathArrFull, target);
+            const soul    = frame.soul ? frame.soul + '/' + k : k;
+            frame.node[k] = { '#': soul };
+            stack.push(createFlattenFrame(value, soul, frame.path + '.' + k, true, target));
         }
         else
         {
-            target[path][k] = value;
+            frame.node[k] = value;
         }
     }
-    return target;
+}
+
+function createFlattenFrame(
+    obj: object,
+    soul: string,
+    path: string,
+    create: boolean,
+    target: TGGraphData,
+): TGFlattenFrame
+{
+    if (create && !isObject(target[soul]))
+    {
+        target[soul] = {} as TGNode;
+    }
+
+    return {
+        obj,
+        soul,
+        path,
+        node : target[soul],
+        keys : Object.keys(obj).filter(key => key !== '_'),
+        index: 0,
+    };
+}
+
+function toFlattenRoot(data: TGValue, fullPath: string[]): {
+    obj: object,
+    pathArr: string[],
+    soul: string
+}
+{
+    if (isObject(data))
+    {
+        const soul = fullPath.join('/');
+        return { obj: data, pathArr: [soul], soul };
+    }
+    else
+    {
+        const propertyName = fullPath.pop();
+        const soul         = fullPath.join('/');
+        return { obj: { [propertyName]: data }, pathArr: [soul], soul };
+    }
 }
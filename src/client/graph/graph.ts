@@ -1,9 +1,10 @@
-import { isUndefined, isDefined } from 'topgun-typed';
+import { isUndefined, isDefined, isNumber } from 'topgun-typed';
 import { AsyncStreamEmitter } from 'topgun-async-stream-emitter';
-import { addMissingState, mergeNodes } from '../../crdt';
+import { addMissingState, mergeNodes, summarizeNode } from '../../crdt';
 import {
     TGGet,
     TGGraphData,
+    TGGraphSummary,
     TGMessageCb,
     TGValue,
     TGOptionsPut,
@@ -13,20 +14,31 @@ import {
 } from '../../types';
 import { TGGraphConnector } from '../transports/graph-connector';
 import {
-    diffSets,
     getNodesFromGraph,
-    getPathData,
-    flattenGraphData
+    resolvePath,
+    flattenGraphData,
+    flattenGraphDataChunks,
+    TGPathCursor,
 } from './graph-utils';
 import { getNodeSoul } from '../../utils/node';
 import { TGGraphQuery } from './graph-query';
+import { TGGraphQueryIndex } from './graph-query-index';
 import { stringifyOptionsGet } from '../../utils/stringify-options-get';
 import { uuidv4 } from '../../utils/uuidv4';
 import { TGStream } from '../../stream/stream';
+import { jsonByteLength, storageListOptionsFromGetOptions, utf8ByteLength } from '../../storage/utils';
+import { SortedKeyIndex } from '../../storage/sorted-key-index';
 
-interface TGGraphOptions
+/** Most nodes summarized for a single lex query */
+export const MAX_SUMMARY_SOULS = 1000;
+
+export interface TGGraphOptions
 {
     readonly mutable?: boolean;
+    /** Serialized size in bytes the cached nodes may take, 0 for no limit */
+    readonly memoryBudget?: number;
+    /** Connector evicted nodes are written to, so they can be read back through it */
+    readonly spillTo?: TGGraphConnector;
 }
 
 /**
@@ -45,9 +57,15 @@ export class TGGraph extends AsyncStreamEmitter<any>
     private readonly _readMiddleware: TGMiddleware[];
     private readonly _writeMiddleware: TGMiddleware[];
     private readonly _graph: TGGraphData;
+    /** Souls of the cached nodes in key order, ranged gets summarize only the souls they list */
+    private readonly _souls: SortedKeyIndex;
     private readonly _queries: {
         [queryString: string]: TGGraphQuery;
     };
+    private readonly _queryIndex: TGGraphQueryIndex;
+    /** Serialized size of the cached nodes, least recently received first */
+    private readonly _nodeSizes: Map<string, number>;
+    private _bytes: number;
     private readonly rootEventEmitter: AsyncStreamEmitter<any>;
 
     /**
@@ -64,13 +82,45 @@ export class TGGraph extends AsyncStreamEmitter<any>
         this.activeConnectors    = 0;
         this._opt                = {};
         this._graph              = {};
+        this._souls              = new SortedKeyIndex();
         this._queries            = {};
+        this._queryIndex         = new TGGraphQueryIndex();
+        this._nodeSizes          = new Map();
+        this._bytes              = 0;
         this.connectors          = [];
         this._readMiddleware     = [];
         this._writeMiddleware    = [];
         this.rootEventEmitter    = rootEventEmitter;
     }
 
+    // -----------------------------------------------------------------------------------------------------
+    // @ Accessors
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Serialized size in bytes of the cached nodes, tracked while a memory budget is set
+     */
+    get memoryUsage(): number
+    {
+        return this._bytes;
+    }
+
+    /**
+     * True while a connector has a saturated output queue, puts then wait for it to drain
+     */
+    get isSaturated(): boolean
+    {
+        return this.connectors.some(connector => connector.isSaturated);
+    }
+
+    /**
+     * Cached nodes by soul, a soul mapped to null was answered without a node
+     */
+    get nodes(): Readonly<TGGraphData>
+    {
+        return this._graph;
+    }
+
     // -----------------------------------------------------------------------------------------------------
     // @ Public methods
     // -----------------------------------------------------------------------------------------------------
@@ -81,6 +131,18 @@ export class TGGraph extends AsyncStreamEmitter<any>
     opt(options: TGGraphOptions): TGGraph
     {
         this._opt = { ...this._opt, ...options };
+
+        if (this._opt.memoryBudget > 0)
+        {
+            this._trackAll();
+            this._enforceBudget();
+        }
+        else
+        {
+            this._nodeSizes.clear();
+            this._bytes = 0;
+        }
+
         return this;
     }
 
@@ -224,14 +286,21 @@ export class TGGraph extends AsyncStreamEmitter<any>
      */
     query<T extends TGValue>(path: string[], cb: TGOnCb<T>, msgId: string): () => void
     {
-        let lastSouls   = [] as string[];
         let currentValue: TGValue|undefined;
-        const streamMap = new Map<string, TGStream<any>>();
+        const cursor: TGPathCursor = { souls: [], keyIndexes: [] };
+        const streamMap            = new Map<string, TGStream<any>>();
 
-        const updateQuery = () =>
+        const updateQuery = (updatedSoul?: string) =>
         {
-            const { souls, value, complete } = getPathData(path, this._graph);
-            const [added, removed]           = diffSets(lastSouls, souls);
+            // Levels before the updated soul still resolve to the same souls
+            const fromSoul = isUndefined(updatedSoul) ? 0 : cursor.souls.indexOf(updatedSoul);
+
+            if (fromSoul === -1)
+            {
+                return;
+            }
+
+            const { souls, value, complete } = resolvePath(path, this._graph, cursor, fromSoul);
 
             if (
                 (complete && isUndefined(currentValue)) ||
@@ -242,28 +311,35 @@ export class TGGraph extends AsyncStreamEmitter<any>
                 cb(value as T, path[path.length - 1]);
             }
 
-            for (const soul of added)
+            const current = new Set(souls);
+
+            for (const soul of current)
             {
-                const stream = this._listen(this._queryStringBySoul(soul), updateQuery, msgId);
-                streamMap.set(soul, stream);
+                if (!streamMap.has(soul))
+                {
+                    streamMap.set(soul, this._listen(this._queryStringBySoul(soul), () => updateQuery(soul), msgId));
+                }
             }
 
-            for (const soul of removed)
+            for (const [soul, stream] of streamMap)
             {
-                this._unlisten(this._queryStringBySoul(soul), streamMap.get(soul));
+                if (!current.has(soul))
+                {
+                    streamMap.delete(soul);
+                    this._unlisten(this._queryStringBySoul(soul), stream);
+                }
             }
-
-            lastSouls = souls;
         };
 
         updateQuery();
 
         return () =>
         {
-            for (const soul of lastSouls)
+            for (const [soul, stream] of streamMap)
             {
-                this._unlisten(this._queryStringBySoul(soul), streamMap.get(soul));
+                this._unlisten(this._queryStringBySoul(soul), stream);
             }
+            streamMap.clear();
         };
     }
 
@@ -272,13 +348,66 @@ export class TGGraph extends AsyncStreamEmitter<any>
      */
     get(data: TGGet): () => void
     {
-        const msgId = data.msgId || uuidv4();
+        const msgId   = data.msgId || uuidv4();
+        const options = { ...data.options };
+        const summary = this.summarize(options);
 
-        this.emit('get', { ...data, msgId });
+        if (summary)
+        {
+            options['^'] = summary;
+        }
+        else
+        {
+            delete options['^'];
+        }
+
+        this.emit('get', { ...data, msgId, options });
 
         return () => this.emit('off', msgId);
     }
 
+    /**
+     * Summaries of the cached nodes a get would return, so peers can skip unchanged fields.
+     * Lex queries range the sorted souls of the cache and summarize up to MAX_SUMMARY_SOULS of them
+     */
+    summarize(options: TGOptionsGet): TGGraphSummary|undefined
+    {
+        const soul                    = options && options['#'];
+        const summary: TGGraphSummary = {};
+        let count                     = 0;
+
+        if (!soul)
+        {
+            return undefined;
+        }
+        if (this._graph[soul])
+        {
+            summary[soul] = summarizeNode(this._graph[soul]);
+            count++;
+        }
+        if (options['.'])
+        {
+            const listOptions = storageListOptionsFromGetOptions(options);
+            const limit       = isNumber(listOptions.limit) ? Math.min(listOptions.limit, MAX_SUMMARY_SOULS) : MAX_SUMMARY_SOULS;
+
+            // One more, the soul itself may be listed
+            for (const key of this._souls.range({ ...listOptions, limit: limit + 1 }))
+            {
+                if (count >= MAX_SUMMARY_SOULS)
+                {
+                    break;
+                }
+                if (key !== soul && this._graph[key])
+                {
+                    summary[key] = summarizeNode(this._graph[key]);
+                    count++;
+                }
+            }
+        }
+
+        return count ? summary : undefined;
+    }
+
     /**
      * Write graph data to a potentially multi-level deep path in the graph
      *
@@ -309,6 +438,12 @@ export class TGGraph extends AsyncStreamEmitter<any>
             throw err;
         }
 
+        if (putOpt?.chunkSize > 0)
+        {
+            this._putPathChunks(fullPath, data, cb, putOpt);
+            return;
+        }
+
         const { graphData, soul } = flattenGraphData(data, fullPath);
 
         this.put(graphData, cb, soul, putOpt);
@@ -353,6 +488,12 @@ export class TGGraph extends AsyncStreamEmitter<any>
 
             await this.receiveGraphData(diff);
 
+            // The put is applied locally, it is handed to the connectors and acknowledged once they have room
+            if (this.isSaturated)
+            {
+                await this.waitForDrain();
+            }
+
             this.emit('put', {
                 cb,
                 graph: diff,
@@ -373,6 +514,17 @@ export class TGGraph extends AsyncStreamEmitter<any>
         return () => this.emit('off', id);
     }
 
+    /**
+     * Resolves once no connector has a saturated output queue
+     */
+    async waitForDrain(): Promise<void>
+    {
+        while (this.isSaturated)
+        {
+            await Promise.all(this.connectors.map(connector => connector.waitForDrain()));
+        }
+    }
+
     /**
      * Invoke callback function for each connector to this graph
      */
@@ -424,16 +576,16 @@ export class TGGraph extends AsyncStreamEmitter<any>
                 this._opt.mutable ? 'mutable' : 'immutable',
             );
 
-            this._eachQuery((query) =>
+            if (node)
             {
-                if (query.match(node))
-                {
-                    query.receive(node);
-                }
-            });
+                this._souls.add(soul);
+            }
+            this._track(soul);
+            this._queryIndex.forEachMatch(node, query => query.receive(node));
         }
 
         this.emit('graphData', { diff, id, replyToId });
+        this._enforceBudget();
     }
 
     // -----------------------------------------------------------------------------------------------------
@@ -442,9 +594,15 @@ export class TGGraph extends AsyncStreamEmitter<any>
 
     private _query(queryString: string): TGGraphQuery
     {
-        return (this._queries[queryString] =
-            this._queries[queryString] ||
-            new TGGraphQuery(this, queryString, this.receiveGraphData));
+        let query = this._queries[queryString];
+
+        if (!query)
+        {
+            query = this._queries[queryString] = new TGGraphQuery(this, queryString, this.receiveGraphData);
+            this._queryIndex.add(query);
+        }
+
+        return query;
     }
 
     private _listen<T extends TGValue>(queryString: string, cb: TGOnCb<T>, msgId?: string): TGStream<any>
@@ -462,19 +620,122 @@ export class TGGraph extends AsyncStreamEmitter<any>
         if (query instanceof TGGraphQuery && query.listenerCount() <= 0)
         {
             query.off();
+            this._queryIndex.remove(query);
             delete this._queries[queryString];
+            this._enforceBudget();
         }
         return this;
     }
 
-    private async _eachQuery(cb: (query: TGGraphQuery) => void): Promise<TGGraph>
+    /**
+     * Put nodes chunk by chunk, leaving connectors a turn between chunks to transmit.
+     * Only the last chunk is acknowledged to the callback
+     */
+    private _putPathChunks(
+        fullPath: string[],
+        data: TGValue,
+        cb: TGMessageCb|undefined,
+        putOpt: TGOptionsPut,
+    ): void
+    {
+        const { chunks, soul } = flattenGraphDataChunks(data, fullPath, putOpt.chunkSize);
+
+        // Invalid data throws here like an unchunked put
+        let next = chunks.next();
+
+        (async () =>
+        {
+            while (!next.done)
+            {
+                const chunk = next.value;
+                next        = chunks.next();
+
+                this.put(chunk, next.done ? cb : undefined, soul, putOpt);
+
+                if (!next.done)
+                {
+                    await new Promise(resolve => setTimeout(resolve, 0));
+                    await this.waitForDrain();
+                }
+            }
+        })();
+    }
+
+    private _trackAll(): void
     {
-        for (const queryString in this._queries)
+        for (const soul in this._graph)
         {
-            await cb(this._queries[queryString]);
+            if (!this._nodeSizes.has(soul))
+            {
+                this._track(soul);
+            }
         }
+    }
 
-        return this;
+    /**
+     * Update the size of a received node and mark it most recently used
+     */
+    private _track(soul: string): void
+    {
+        if (!(this._opt.memoryBudget > 0))
+        {
+            return;
+        }
+
+        const node     = this._graph[soul];
+        const previous = this._nodeSizes.get(soul) || 0;
+        const size     = node ? utf8ByteLength(soul) + jsonByteLength(node) : 0;
+
+        this._nodeSizes.delete(soul);
+        if (size)
+        {
+            this._nodeSizes.set(soul, size);
+        }
+        this._bytes += size - previous;
+    }
+
+    /**
+     * Drop least recently received nodes no active query is interested in, until the cache fits its budget.
+     * Evicted nodes are read again through the connectors when a query asks for them
+     */
+    private _enforceBudget(): void
+    {
+        const budget = this._opt.memoryBudget;
+
+        if (!(budget > 0) || this._bytes <= budget)
+        {
+            return;
+        }
+
+        const evicted: TGGraphData = {};
+        let count                  = 0;
+
+        for (const [soul, size] of this._nodeSizes)
+        {
+            if (this._bytes <= budget)
+            {
+                break;
+            }
+
+            const node = this._graph[soul];
+
+            if (this._queryIndex.hasMatch(node))
+            {
+                continue;
+            }
+
+            evicted[soul] = node;
+            delete this._graph[soul];
+            this._souls.delete(soul);
+            this._nodeSizes.delete(soul);
+            this._bytes -= size;
+            count++;
+        }
+
+        if (count && this._opt.spillTo)
+        {
+            this._opt.spillTo.put({ graph: evicted, msgId: uuidv4() });
+        }
     }
 
     private _queryStringBySoul(soul: string): string
@@ -3,9 +3,10 @@ export { TGGraph } from './graph/graph';
 export { TGLink } from './link';
 export { TGQueue } from './control-flow/queue';
 export { TGProcessQueue } from './control-flow/process-queue';
-export { TGGraphConnector } from './transports/graph-connector';
+export * from './transports/graph-connector';
 export { TGGraphWireConnector } from './transports/graph-wire-connector';
 export { TGGraphConnectorFromAdapter } from './transports/graph-connector-from-adapter';
+export { TGWorkerGraphConnector } from './transports/worker-graph-connector';
 export { TGUserApi } from './user-api';
 export * from '../crdt';
 export * from '../types';
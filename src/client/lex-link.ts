@@ -1,4 +1,4 @@
-import { cloneValue, isNumber, isObject } from 'topgun-typed';
+import { cloneValue, isNumber, isObject, isString } from 'topgun-typed';
 import { TGLink } from './link';
 import { LEX } from '../types/lex';
 import { TGClient } from './client';
@@ -41,6 +41,10 @@ export class TGLexLink
             {
                 this.optionsGet['%'] = optionsGet['%'];
             }
+            if (isString(optionsGet['$']))
+            {
+                this.optionsGet['$'] = optionsGet['$'];
+            }
         }
         this._mergeSoul();
     }
@@ -79,6 +83,15 @@ export class TGLexLink
         return this;
     }
 
+    /**
+     * Resume a list after the cursor of a paged reply
+     */
+    after(cursor: string): TGLexLink
+    {
+        this.optionsGet['$'] = assertNotEmptyString(cursor);
+        return this;
+    }
+
     reverse(value = true): TGLexLink
     {
         this.optionsGet['-'] = assertBoolean(value);
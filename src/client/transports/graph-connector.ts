@@ -1,26 +1,67 @@
 import { AsyncStreamEmitter } from 'topgun-async-stream-emitter';
-import { TGGet, TGPut, TGMessage } from '../../types';
+import { isNumber } from 'topgun-typed';
+import { TG_METRIC_QUEUE_DEPTH, TGGet, TGPut, TGMessage, TGMetrics, TGOptionsGet } from '../../types';
 import { TGProcessQueue } from '../control-flow/process-queue';
 import { TGGraph } from '../graph/graph';
+import { mergeNodes } from '../../crdt';
+
+export const DEFAULT_HIGH_WATER_MARK = 1000;
+
+export interface TGGraphConnectorOptions
+{
+    /**
+     * Queued messages at which a queue is saturated, 1000 by default. The queues are tracked apart,
+     * a saturated output queue holds back the puts of the graph until it drains
+     */
+    highWaterMark?: number;
+    /** Queued messages at which a saturated output queue emits 'drain', half the high water mark by default */
+    lowWaterMark?: number;
+    /**
+     * Merge puts per soul while disconnected, so reconnect sends one diff per node
+     * instead of every intermediate write
+     */
+    coalesceOfflinePuts?: boolean;
+    /** Sink for the queue depths of the connector */
+    metrics?: TGMetrics;
+}
 
 /* eslint-disable @typescript-eslint/no-unused-vars */
 /* eslint-disable @typescript-eslint/no-empty-function */
 export abstract class TGGraphConnector extends AsyncStreamEmitter<any>
 {
     readonly name: string;
+    readonly highWaterMark: number;
+    readonly lowWaterMark: number;
+    readonly coalesceOfflinePuts: boolean;
     isConnected: boolean;
 
     protected readonly inputQueue: TGProcessQueue<TGMessage>;
     protected readonly outputQueue: TGProcessQueue<TGMessage>;
+    protected graph: TGGraph|undefined;
+    protected readonly metrics: TGMetrics|undefined;
+
+    private _saturated: boolean;
+    private _inputSaturated: boolean;
+    /** Queued put that offline puts are merged into */
+    private _offlinePut: TGMessage|null;
 
     /**
      * Constructor
      */
-    protected constructor(name = 'GraphConnector')
+    protected constructor(name = 'GraphConnector', options?: TGGraphConnectorOptions)
     {
         super();
-        this.isConnected = false;
-        this.name        = name;
+        this.isConnected         = false;
+        this.name                = name;
+        this.highWaterMark       = isNumber(options?.highWaterMark) ? options.highWaterMark : DEFAULT_HIGH_WATER_MARK;
+        this.lowWaterMark        = isNumber(options?.lowWaterMark)
+            ? Math.min(options.lowWaterMark, this.highWaterMark)
+            : Math.floor(this.highWaterMark / 2);
+        this.coalesceOfflinePuts = !!options?.coalesceOfflinePuts;
+        this.metrics             = options?.metrics;
+        this._saturated          = false;
+        this._inputSaturated     = false;
+        this._offlinePut         = null;
 
         this.put = this.put.bind(this);
         this.off = this.off.bind(this);
@@ -43,6 +84,37 @@ export abstract class TGGraphConnector extends AsyncStreamEmitter<any>
                 this._onConnectedChange(false);
             }
         })();
+
+        [this.inputQueue, this.outputQueue].forEach((queue) =>
+        {
+            ['completed', 'emptied'].forEach(async (event) =>
+            {
+                for await (const _value of queue.listener(event))
+                {
+                    this._updateBackpressure();
+                }
+            });
+        });
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Accessors
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * True once the output queue reached the high water mark, until it drains to the low water mark
+     */
+    get isSaturated(): boolean
+    {
+        return this._saturated;
+    }
+
+    /**
+     * True once the input queue reached the high water mark, until it drains to the low water mark
+     */
+    get isInputSaturated(): boolean
+    {
+        return this._inputSaturated;
     }
 
     // -----------------------------------------------------------------------------------------------------
@@ -51,6 +123,8 @@ export abstract class TGGraphConnector extends AsyncStreamEmitter<any>
 
     connectToGraph(graph: TGGraph): TGGraphConnector
     {
+        this.graph = graph;
+
         (async () =>
         {
             for await (const value of graph.listener('off'))
@@ -100,6 +174,19 @@ export abstract class TGGraphConnector extends AsyncStreamEmitter<any>
         return this.listener('connect').once();
     }
 
+    /**
+     * Resolves once the output queue is no longer saturated, producers may await it between writes
+     */
+    waitForDrain(): Promise<void>
+    {
+        if (!this._saturated)
+        {
+            return Promise.resolve();
+        }
+
+        return this.listener('drain').once();
+    }
+
     /**
      * Send graph data for one or more nodes
      *
@@ -131,7 +218,14 @@ export abstract class TGGraphConnector extends AsyncStreamEmitter<any>
      */
     send(msgs: readonly TGMessage[]): TGGraphConnector
     {
+        if (!this.isConnected && this.coalesceOfflinePuts)
+        {
+            msgs = msgs.filter(msg => !this._coalescePut(msg));
+        }
+
         this.outputQueue.enqueueMany(msgs);
+        this._updateBackpressure();
+
         if (this.isConnected)
         {
             this.outputQueue.process();
@@ -147,7 +241,9 @@ export abstract class TGGraphConnector extends AsyncStreamEmitter<any>
      */
     ingest(msgs: readonly TGMessage[]): TGGraphConnector
     {
-        this.inputQueue.enqueueMany(msgs).process();
+        this.inputQueue.enqueueMany(msgs);
+        this._updateBackpressure();
+        this.inputQueue.process();
 
         return this;
     }
@@ -160,15 +256,113 @@ export abstract class TGGraphConnector extends AsyncStreamEmitter<any>
     {
     }
 
+    // -----------------------------------------------------------------------------------------------------
+    // @ Protected methods
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Called when an offline put was merged into an already queued put
+     *
+     * @param _msg The merged put, it will not be sent
+     * @param _into The queued put now carrying its data
+     */
+    protected onCoalesced(_msg: TGMessage, _into: TGMessage): void
+    {
+    }
+
+    /**
+     * Update the node summaries of a get in place before it is sent again,
+     * the graph may have received data since the get was issued
+     */
+    protected refreshSummary(options: TGOptionsGet): void
+    {
+        const summary = this.graph && this.graph.summarize(options);
+
+        if (summary)
+        {
+            options['^'] = summary;
+        }
+        else
+        {
+            delete options['^'];
+        }
+    }
+
     // -----------------------------------------------------------------------------------------------------
     // @ Private methods
     // -----------------------------------------------------------------------------------------------------
 
+    /**
+     * Merge a put into the queued offline put, replacing the message by an owned copy on first use
+     *
+     * @returns true when the message was merged and must not be queued
+     */
+    private _coalescePut(msg: TGMessage): boolean
+    {
+        if (!msg.put || msg['@'] || 'get' in msg)
+        {
+            return false;
+        }
+
+        const target = this._offlinePut;
+
+        // The previous target may already be in flight
+        if (!target || !this.outputQueue.has(target))
+        {
+            this._offlinePut = { ...msg, put: { ...msg.put } };
+            this.outputQueue.enqueue(this._offlinePut);
+            return true;
+        }
+
+        for (const soul in msg.put)
+        {
+            if (soul)
+            {
+                target.put[soul] = mergeNodes(target.put[soul], msg.put[soul]);
+            }
+        }
+
+        this.onCoalesced(msg, target);
+        return true;
+    }
+
+    private _updateBackpressure(): void
+    {
+        const input  = this.inputQueue.count();
+        const output = this.outputQueue.count();
+
+        if (this.metrics)
+        {
+            this.metrics.gauge(TG_METRIC_QUEUE_DEPTH, input, { connector: this.name, queue: 'input' });
+            this.metrics.gauge(TG_METRIC_QUEUE_DEPTH, output, { connector: this.name, queue: 'output' });
+        }
+
+        if (!this._inputSaturated && input >= this.highWaterMark)
+        {
+            this._inputSaturated = true;
+        }
+        else if (this._inputSaturated && input <= this.lowWaterMark)
+        {
+            this._inputSaturated = false;
+        }
+
+        if (!this._saturated && output >= this.highWaterMark)
+        {
+            this._saturated = true;
+        }
+        else if (this._saturated && output <= this.lowWaterMark)
+        {
+            this._saturated = false;
+            this.emit('drain', {});
+        }
+    }
+
     private _onConnectedChange(connected?: boolean): void
     {
         if (connected)
         {
             this.isConnected = true;
+            this._offlinePut = null;
             this.outputQueue.process();
         }
         else
@@ -1,5 +1,5 @@
 import { TGGet, TGPut, TGMessage, TGMessageCb } from '../../types';
-import { TGGraphConnector } from './graph-connector';
+import { TGGraphConnector, TGGraphConnectorOptions } from './graph-connector';
 import { uuidv4 } from '../../utils/uuidv4';
 
 /* eslint-disable @typescript-eslint/no-empty-function */
@@ -8,14 +8,19 @@ export class TGGraphWireConnector extends TGGraphConnector
     private readonly _callbacks: {
         [msgId: string]: TGMessageCb;
     };
+    /** Ids of coalesced puts, answered by the reply to the put they were merged into */
+    private readonly _aliases: {
+        [msgId: string]: string[];
+    };
 
     /**
      * Constructor
      */
-    constructor(name = 'GraphWireConnector')
+    constructor(name = 'GraphWireConnector', options?: TGGraphConnectorOptions)
     {
-        super(name);
+        super(name, options);
         this._callbacks = {};
+        this._aliases   = {};
 
         (async () =>
         {
@@ -101,6 +106,21 @@ export class TGGraphWireConnector extends TGGraphConnector
         };
     }
 
+    // -----------------------------------------------------------------------------------------------------
+    // @ Protected methods
+    // -----------------------------------------------------------------------------------------------------
+
+    protected onCoalesced(msg: TGMessage, into: TGMessage): void
+    {
+        const msgId  = msg['#'];
+        const intoId = into['#'];
+
+        if (msgId && intoId && this._callbacks[msgId])
+        {
+            (this._aliases[intoId] = this._aliases[intoId] || []).push(msgId);
+        }
+    }
+
     // -----------------------------------------------------------------------------------------------------
     // @ Private methods
     // -----------------------------------------------------------------------------------------------------
@@ -111,7 +131,7 @@ export class TGGraphWireConnector extends TGGraphConnector
         {
             return;
         }
-        const id      = msg['#'];
+        const id        = msg['#'];
         const replyToId = msg['@'];
 
         if (msg.put)
@@ -130,8 +150,32 @@ export class TGGraphWireConnector extends TGGraphConnector
             {
                 cb(msg);
             }
+            this._replyToAliases(replyToId, msg);
         }
 
         this.emit('receiveMessage', msg);
     }
+
+    /**
+     * Forward a reply to the puts coalesced into the answered one, once
+     */
+    private _replyToAliases(replyToId: string, msg: TGMessage): void
+    {
+        const aliases = this._aliases[replyToId];
+
+        if (!aliases)
+        {
+            return;
+        }
+
+        delete this._aliases[replyToId];
+        aliases.forEach((alias) =>
+        {
+            const cb = this._callbacks[alias];
+            if (cb)
+            {
+                cb({ ...msg, '@': alias });
+            }
+        });
+    }
 }
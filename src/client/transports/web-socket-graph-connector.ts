@@ -1,4 +1,6 @@
+import { isObject, isString } from 'topgun-typed';
 import { TGGraphWireConnector } from './graph-wire-connector';
+import { TGGraphConnectorOptions } from './graph-connector';
 import { TGChannel } from 'topgun-socket/channel';
 import {
     TGSocketClientOptions,
@@ -6,20 +8,35 @@ import {
     create as createSocketClient,
     SubscribeOptions,
 } from 'topgun-socket/client';
-import { TGGet, TGMessage, TGMessageCb, TGPut } from '../../types';
+import { TG_MUX_EVENT, TGGet, TGMessage, TGMessageCb, TGMuxFrame, TGOptionsGet, TGPut } from '../../types';
 import { sign } from '../../sea';
 import { uuidv4 } from '../../utils/uuidv4';
 
+export interface TGWebSocketConnectorOptions extends TGGraphConnectorOptions
+{
+    /**
+     * Carry gets, puts and their replies as batched frames over the connection
+     * instead of subscribing to a channel per request. Requires a server supporting multiplexed frames
+     */
+    multiplex?: boolean;
+}
+
 /* eslint-disable @typescript-eslint/no-empty-function */
 /* eslint-disable-next-line @typescript-eslint/no-unused-vars */
 export class TGWebSocketGraphConnector extends TGGraphWireConnector
 {
     readonly client: TGClientSocket;
     readonly opts: TGSocketClientOptions|undefined;
+    readonly multiplex: boolean;
 
     private readonly _requestChannels: {
         [msgId: string]: TGChannel<any>;
     };
+    /** Active multiplexed gets, null until sent. Sent gets are replayed after reconnecting */
+    private readonly _muxGets: Map<string, TGMessage|null>;
+    /** Subscribe data of the node channels, resent by the socket after reconnecting */
+    private readonly _channelGets: Map<string, TGOptionsGet>;
+    private _muxFrame: TGMuxFrame|null;
 
     /**
      * Constructor
@@ -27,15 +44,26 @@ export class TGWebSocketGraphConnector extends TGGraphWireConnector
     constructor(
         opts: TGSocketClientOptions|undefined,
         name = 'TGWebSocketGraphConnector',
+        connectorOptions?: TGWebSocketConnectorOptions,
     )
     {
-        super(name);
+        super(name, connectorOptions);
         this._requestChannels = {};
+        this._muxGets         = new Map();
+        this._channelGets     = new Map();
+        this._muxFrame        = null;
+        this.multiplex        = !!connectorOptions?.multiplex;
         this.opts             = opts;
         this.client           = createSocketClient(this.opts || {});
         this.onConnect();
+        this.onDisconnect();
         this.onError();
 
+        if (this.multiplex)
+        {
+            this.onMuxFrame();
+        }
+
         (async () =>
         {
             for await (const value of this.outputQueue.listener('completed'))
@@ -66,11 +94,22 @@ export class TGWebSocketGraphConnector extends TGGraphWireConnector
         super.off(msgId);
         const channel = this._requestChannels[msgId];
 
+        if (this._muxGets.has(msgId))
+        {
+            // Only the server knows about gets already sent
+            if (this._muxGets.get(msgId))
+            {
+                this.queueMuxFrame({ off: [msgId] });
+            }
+            this._muxGets.delete(msgId);
+        }
+
         if (channel)
         {
             channel.unsubscribe();
             delete this._requestChannels[msgId];
         }
+        this._channelGets.delete(msgId);
 
         return this;
     }
@@ -79,6 +118,13 @@ export class TGWebSocketGraphConnector extends TGGraphWireConnector
     {
         const soul   = options['#'];
         msgId        = msgId || uuidv4();
+
+        if (this.multiplex)
+        {
+            this._muxGets.set(msgId, null);
+            return super.get({ msgId, cb, options });
+        }
+
         const cbWrap = (msg: any) =>
         {
             this.ingest([msg]);
@@ -88,6 +134,7 @@ export class TGWebSocketGraphConnector extends TGGraphWireConnector
             }
         };
 
+        this._channelGets.set(msgId, options);
         this._requestChannels[msgId] = this.subscribeToChannel(
             `topgun/nodes/${soul}`,
             cbWrap,
@@ -110,7 +157,17 @@ export class TGWebSocketGraphConnector extends TGGraphWireConnector
 
         msgId = msgId || uuidv4();
 
-        if (cb)
+        if (cb && this.multiplex)
+        {
+            const cbOnce = (response: TGMessage) =>
+            {
+                cb(response);
+                this.off(msgId);
+            };
+
+            return super.put({ graph, msgId, replyTo, cb: cbOnce });
+        }
+        else if (cb)
         {
             const cbWrap = (response: any) =>
             {
@@ -184,6 +241,39 @@ export class TGWebSocketGraphConnector extends TGGraphWireConnector
         return channel;
     }
 
+    // -----------------------------------------------------------------------------------------------------
+    // @ Protected methods
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * The coalesced put gets its reply through the put it was merged into,
+     * make sure that put listens for a reply
+     */
+    protected onCoalesced(msg: TGMessage, into: TGMessage): void
+    {
+        super.onCoalesced(msg, into);
+
+        const msgId   = msg['#'];
+        const intoId  = into['#'];
+        const channel = this._requestChannels[msgId];
+
+        if (!channel)
+        {
+            return;
+        }
+
+        channel.unsubscribe();
+        delete this._requestChannels[msgId];
+
+        if (!this._requestChannels[intoId])
+        {
+            this._requestChannels[intoId] = this.subscribeToChannel(
+                `topgun/@${intoId}`,
+                () => this.off(intoId),
+            );
+        }
+    }
+
     // -----------------------------------------------------------------------------------------------------
     // @ Private methods
     // -----------------------------------------------------------------------------------------------------
@@ -218,7 +308,23 @@ export class TGWebSocketGraphConnector extends TGGraphWireConnector
 
     private onOutputProcessed(msg: TGMessage): void
     {
-        if (msg && this.client)
+        if (msg && this.client && this.multiplex)
+        {
+            const msgId = msg['#'];
+
+            if ('get' in msg && !msg['@'])
+            {
+                // Released before it was sent
+                if (!msgId || !this._muxGets.has(msgId))
+                {
+                    return;
+                }
+                this._muxGets.set(msgId, msg);
+            }
+
+            this.queueMuxFrame({ msgs: [msg] });
+        }
+        else if (msg && this.client)
         {
             const replyTo = msg['@'];
 
@@ -240,10 +346,61 @@ export class TGWebSocketGraphConnector extends TGGraphWireConnector
         }
     }
 
+    /**
+     * Add messages to the frame sent at the end of the tick
+     */
+    private queueMuxFrame(frame: TGMuxFrame): void
+    {
+        if (!this._muxFrame)
+        {
+            this._muxFrame = {};
+            Promise.resolve().then(() =>
+            {
+                const pending  = this._muxFrame;
+                this._muxFrame = null;
+                this.client.transmit(TG_MUX_EVENT, pending);
+            });
+        }
+
+        if (frame.msgs)
+        {
+            this._muxFrame.msgs = (this._muxFrame.msgs || []).concat(frame.msgs);
+        }
+        if (frame.off)
+        {
+            this._muxFrame.off = (this._muxFrame.off || []).concat(frame.off);
+        }
+    }
+
+    private async onMuxFrame(): Promise<void>
+    {
+        for await (const frame of this.client.receiver(TG_MUX_EVENT))
+        {
+            const msgs = (frame as TGMuxFrame)?.msgs;
+
+            if (Array.isArray(msgs) && msgs.length)
+            {
+                this.ingest(msgs);
+            }
+        }
+    }
+
     private async onConnect(): Promise<void>
     {
         for await (const _event of this.client.listener('connect'))
         {
+            // The server forgets the interest of a closed connection, announce the active gets again
+            if (this.multiplex)
+            {
+                const msgs = [...this._muxGets.values()].filter(msg => !!msg) as TGMessage[];
+
+                if (msgs.length)
+                {
+                    msgs.forEach(msg => msg.get && this.refreshSummary(msg.get));
+                    this.queueMuxFrame({ msgs });
+                }
+            }
+
             try
             {
                 this.emit('connect', {});
@@ -255,6 +412,18 @@ export class TGWebSocketGraphConnector extends TGGraphWireConnector
         }
     }
 
+    /**
+     * Node channels are subscribed again with their stored data after reconnecting,
+     * refresh their summaries while the connection is down
+     */
+    private async onDisconnect(): Promise<void>
+    {
+        for await (const _event of this.client.listener('disconnect'))
+        {
+            this._channelGets.forEach(options => this.refreshSummary(options));
+        }
+    }
+
     private async onError(): Promise<void>
     {
         for await (const _event of this.client.listener('error'))
@@ -271,7 +440,51 @@ export class TGWebSocketGraphConnector extends TGGraphWireConnector
 
 export function createConnector(
     opts: TGSocketClientOptions|undefined,
+    connectorOptions?: TGWebSocketConnectorOptions,
 ): TGWebSocketGraphConnector
 {
-    return new TGWebSocketGraphConnector(opts);
+    return new TGWebSocketGraphConnector(opts, undefined, connectorOptions);
+}
+
+/**
+ * Connectors for peers given as URLs or socket options, invalid peers are logged and skipped
+ */
+export function createPeerConnectors(
+    peers: (string|TGSocketClientOptions)[],
+    connectorOptions?: TGWebSocketConnectorOptions,
+): TGWebSocketGraphConnector[]
+{
+    const connectors: TGWebSocketGraphConnector[] = [];
+
+    peers.forEach((peer) =>
+    {
+        try
+        {
+            if (isString(peer))
+            {
+                const url                            = new URL(peer);
+                const options: TGSocketClientOptions = {
+                    hostname: url.hostname,
+                    secure  : url.protocol.includes('https'),
+                };
+
+                if (url.port.length > 0)
+                {
+                    options.port = Number(url.port);
+                }
+
+                connectors.push(createConnector(options, connectorOptions));
+            }
+            else if (isObject(peer))
+            {
+                connectors.push(createConnector(peer, connectorOptions));
+            }
+        }
+        catch (e)
+        {
+            console.error(e);
+        }
+    });
+
+    return connectors;
 }
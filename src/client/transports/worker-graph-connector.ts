@@ -0,0 +1,223 @@
+import { isFunction, isNumber } from 'topgun-typed';
+import { TGGet, TGMessage, TGWorkerFrame, TGWorkerPort } from '../../types';
+import { TGGraphWireConnector } from './graph-wire-connector';
+import { TGGraphConnectorOptions } from './graph-connector';
+import { uuidv4 } from '../../utils/uuidv4';
+import globalScope from '../../utils/window-or-global';
+
+export interface TGWorkerGraphConnectorOptions extends TGGraphConnectorOptions
+{
+    /** Milliseconds between heartbeats to the host, 5000 by default and 0 disables them */
+    heartbeatInterval?: number;
+}
+
+const DEFAULT_HEARTBEAT_INTERVAL = 5000;
+
+/**
+ * Connects a graph to a graph hosted in a worker, see `startWorkerHost`.
+ *
+ * The worker keeps the peer connections, the local storage and one graph shared by all of its tabs,
+ * the graph of a tab only holds the nodes its queries read. Messages of a tick are posted as one frame.
+ * A heartbeat tells the host the tab is alive, and leaving the page releases its gets right away
+ */
+export class TGWorkerGraphConnector extends TGGraphWireConnector
+{
+    readonly port: TGWorkerPort;
+
+    /** Active gets, false until sent. Only gets the host knows about are released on it */
+    private readonly _gets: Map<string, boolean>;
+    private readonly _onPageHide: () => void;
+    private _frame: TGWorkerFrame|null;
+    private _heartbeat: ReturnType<typeof setInterval>|null;
+
+    /**
+     * Constructor
+     */
+    constructor(port: TGWorkerPort, name = 'TGWorkerGraphConnector', options?: TGWorkerGraphConnectorOptions)
+    {
+        super(name, options);
+        this.port        = port;
+        this._gets       = new Map();
+        this._frame      = null;
+        this._heartbeat  = null;
+        // Microtasks may not run while a page unloads, the host is told synchronously
+        this._onPageHide = () => this.port.postMessage({ close: true });
+
+        this.port.addEventListener('message', event => this._receive(event.data));
+        if (isFunction(this.port.start))
+        {
+            this.port.start();
+        }
+
+        const interval = isNumber(options?.heartbeatInterval) ? options.heartbeatInterval : DEFAULT_HEARTBEAT_INTERVAL;
+
+        if (interval > 0)
+        {
+            this._heartbeat = setInterval(() => this._queueFrame({ ping: true }), interval);
+        }
+        if (isFunction(globalScope?.addEventListener) && 'onpagehide' in globalScope)
+        {
+            globalScope.addEventListener('pagehide', this._onPageHide);
+        }
+
+        (async () =>
+        {
+            for await (const value of this.outputQueue.listener('completed'))
+            {
+                this._onOutputProcessed(value);
+            }
+        })();
+
+        // Ports buffer frames until the host listens
+        Promise.resolve().then(() => this.emit('connect', {}));
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    get({ msgId, cb, options }: TGGet): () => void
+    {
+        msgId = msgId || uuidv4();
+        this._gets.set(msgId, false);
+
+        return super.get({ msgId, cb, options });
+    }
+
+    off(msgId: string): TGWorkerGraphConnector
+    {
+        super.off(msgId);
+
+        if (this._gets.get(msgId))
+        {
+            this._queueFrame({ off: [msgId] });
+        }
+        this._gets.delete(msgId);
+
+        return this;
+    }
+
+    /**
+     * Tell the host which user this tab signed in as. The keys stay in the tab,
+     * the host signs its shared peers in as its own user and refuses tabs of another one
+     */
+    async authenticate(pub: string, _priv: string): Promise<void>
+    {
+        this._queueFrame({ auth: { pub } });
+    }
+
+    /**
+     * Release the gets of this tab on the host, the host keeps running for the other tabs
+     */
+    async disconnect(): Promise<void>
+    {
+        this._release();
+        this._queueFrame({ close: true });
+        await Promise.resolve();
+        this.emit('disconnect', {});
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    private _onOutputProcessed(msg: TGMessage): void
+    {
+        if (!msg)
+        {
+            return;
+        }
+
+        const msgId = msg['#'];
+
+        if ('get' in msg && !msg['@'])
+        {
+            // Released before it was sent
+            if (!msgId || !this._gets.has(msgId))
+            {
+                return;
+            }
+            this._gets.set(msgId, true);
+        }
+
+        this._queueFrame({ msgs: [msg] });
+    }
+
+    /**
+     * Add to the frame posted at the end of the tick
+     */
+    private _queueFrame(frame: TGWorkerFrame): void
+    {
+        if (!this._frame)
+        {
+            this._frame = {};
+            Promise.resolve().then(() =>
+            {
+                const pending = this._frame;
+                this._frame   = null;
+                this.port.postMessage(pending);
+            });
+        }
+
+        this._frame = mergeWorkerFrames(this._frame, frame);
+    }
+
+    private _receive(frame: TGWorkerFrame): void
+    {
+        const msgs = frame?.msgs;
+
+        if (Array.isArray(msgs) && msgs.length)
+        {
+            this.ingest(msgs);
+        }
+        if (frame?.close)
+        {
+            console.warn(frame.err || 'Worker host closed the port');
+            this._release();
+            this.emit('disconnect', {});
+        }
+    }
+
+    private _release(): void
+    {
+        if (this._heartbeat)
+        {
+            clearInterval(this._heartbeat);
+            this._heartbeat = null;
+        }
+        if (isFunction(globalScope?.removeEventListener))
+        {
+            globalScope.removeEventListener('pagehide', this._onPageHide);
+        }
+        this._gets.clear();
+    }
+}
+
+/**
+ * Append the messages and releases of a frame to another
+ */
+export function mergeWorkerFrames(target: TGWorkerFrame, frame: TGWorkerFrame): TGWorkerFrame
+{
+    if (frame.msgs)
+    {
+        target.msgs = (target.msgs || []).concat(frame.msgs);
+    }
+    if (frame.off)
+    {
+        target.off = (target.off || []).concat(frame.off);
+    }
+    if (frame.auth)
+    {
+        target.auth = frame.auth;
+    }
+    if (frame.close)
+    {
+        target.close = true;
+    }
+    if (frame.ping)
+    {
+        target.ping = true;
+    }
+
+    return target;
+}
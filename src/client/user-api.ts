@@ -1,5 +1,5 @@
 import { isObject, isString, isFunction, object, fn } from 'topgun-typed';
-import { authenticate, createUser, graphSigner } from '../sea';
+import { authenticate, clearSignKey, createUser, graphSigner } from '../sea';
 import { TGClient } from './client';
 import {
     getItemAsync,
@@ -180,6 +180,10 @@ export class TGUserApi
     {
         if (this._signMiddleware)
         {
+            if (this.is)
+            {
+                clearSignKey(this.is.pub);
+            }
             this._removeCredentials();
             this.is = undefined;
         }
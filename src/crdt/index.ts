@@ -5,13 +5,25 @@ import {
     TGNodeMeta,
     TGNodeState,
 } from '../types';
-import { cloneValue } from 'topgun-typed';
+
+export * from './summary';
 
 const EMPTY: any = {};
 
+/**
+ * Keys changed by a merge, per soul
+ */
+export interface TGGraphChanges
+{
+    [soul: string]: string[];
+}
+
+/**
+ * Fills in soul and state metadata in place, the returned graph shares its nodes with the input
+ */
 export function addMissingState(graphData: Partial<TGGraphData>): TGGraphData
 {
-    const updatedGraphData = cloneValue(graphData);
+    const updatedGraphData = { ...graphData };
     const now              = new Date().getTime();
 
     for (const soul in graphData)
@@ -46,7 +58,6 @@ export function addMissingState(graphData: Partial<TGGraphData>): TGGraphData
 }
 
 const DEFAULT_OPTS = {
-    Lexical    : JSON.stringify,
     futureGrace: 10 * 60 * 1000,
 };
 
@@ -59,7 +70,6 @@ export function diffCRDT(
     const {
         machineState = new Date().getTime(),
         futureGrace  = DEFAULT_OPTS.futureGrace,
-        Lexical      = DEFAULT_OPTS.Lexical,
     }        = opts || EMPTY;
     const maxState = machineState + futureGrace;
 
@@ -103,27 +113,12 @@ export function diffCRDT(
                 continue;
             }
 
-            const existingKeyState = existingState[key];
-            const updatedKeyState  = updatedState[key];
+            const updatedKeyState = updatedState[key];
 
-            if (updatedKeyState > maxState || !updatedKeyState)
+            if (!isUpdateWinner(existingState[key], updatedKeyState, maxState))
             {
                 continue;
             }
-            if (existingKeyState && existingKeyState >= updatedKeyState)
-            {
-                continue;
-            }
-            if (existingKeyState === updatedKeyState)
-            {
-                const existingVal = (existing && existing[key]) || undefined;
-                const updatedVal  = updated[key];
-                // This is based on TopGun logic
-                if (Lexical(updatedVal) <= Lexical(existingVal))
-                {
-                    continue;
-                }
-            }
             updates[key] = updated[key];
 
             if (updates._ && updates._['>'])
@@ -143,6 +138,107 @@ export function diffCRDT(
     return Object.keys(allUpdates).length > 0 ? allUpdates : undefined;
 }
 
+/**
+ * HAM-resolve updates against the existing graph and apply the winning fields in place.
+ *
+ * Existing nodes are mutated and share values with the updates, souls missing from the
+ * existing graph get a new node. Only the changed keys are reported, undefined when nothing changed
+ */
+export function mergeGraphInPlace(
+    existingGraph: TGGraphData,
+    updatedGraph: TGGraphData,
+    opts: CRDTOpts = DEFAULT_OPTS,
+): TGGraphChanges|undefined
+{
+    const {
+        machineState = new Date().getTime(),
+        futureGrace  = DEFAULT_OPTS.futureGrace,
+    }        = opts || EMPTY;
+    const maxState = machineState + futureGrace;
+
+    let changes: TGGraphChanges|undefined;
+
+    for (const soul in updatedGraph)
+    {
+        const updated = updatedGraph[soul];
+
+        if (!soul || !updated)
+        {
+            continue;
+        }
+
+        const updatedState: TGNodeState = (updated._ && updated._['>']) || EMPTY;
+        let existing                    = existingGraph[soul];
+        let changedKeys: string[]|undefined;
+
+        for (const key in updatedState)
+        {
+            if (!key)
+            {
+                continue;
+            }
+
+            const existingState: TGNodeState = (existing && existing._ && existing._['>']) || EMPTY;
+            const updatedKeyState            = updatedState[key];
+
+            if (!isUpdateWinner(existingState[key], updatedKeyState, maxState))
+            {
+                continue;
+            }
+
+            if (!existing)
+            {
+                existing = existingGraph[soul] = { _: { '#': soul, '>': {} } };
+            }
+            if (!existing._)
+            {
+                existing._ = { '#': soul, '>': {} };
+            }
+            if (!existing._['>'])
+            {
+                existing._['>'] = {};
+            }
+
+            existing[key]        = updated[key];
+            existing._['>'][key] = updatedKeyState;
+
+            if (!changedKeys)
+            {
+                changes     = changes || {};
+                changedKeys = changes[soul] = [];
+            }
+            changedKeys.push(key);
+        }
+    }
+
+    return changes;
+}
+
+/**
+ * Partial nodes holding only the changed keys, for consumers that need a graph diff
+ */
+export function diffFromChanges(graph: TGGraphData, changes: TGGraphChanges): TGGraphData
+{
+    const diff: TGGraphData = {};
+
+    for (const soul in changes)
+    {
+        const node            = graph[soul];
+        const state           = node._['>'];
+        const updates: TGNode = { _: { '#': soul, '>': {} } };
+
+        for (const key of changes[soul])
+        {
+            updates[key]        = node[key];
+            updates._['>'][key] = state[key];
+        }
+
+        diff[soul] = updates;
+    }
+
+    return diff;
+}
+
 export function mergeNodes(
     existing: TGNode|undefined,
     updates: TGNode|undefined,
@@ -199,7 +295,7 @@ export function mergeGraph(
     mut: 'immutable'|'mutable' = 'immutable',
 ): TGGraphData
 {
-    const result: TGGraphData = mut ? existing : { ...existing };
+    const result: TGGraphData = mut === 'mutable' ? existing : { ...existing };
 
     for (const soul in diff)
     {
@@ -211,3 +307,20 @@ export function mergeGraph(
     }
     return result;
 }
+
+/**
+ * HAM: decide whether the updated value of a key should replace the existing one
+ */
+function isUpdateWinner(
+    existingKeyState: number|undefined,
+    updatedKeyState: number,
+    maxState: number,
+): boolean
+{
+    if (updatedKeyState > maxState || !updatedKeyState)
+    {
+        return false;
+    }
+    // Ties keep the existing value
+    return !existingKeyState || existingKeyState < updatedKeyState;
+}
@@ -0,0 +1,107 @@
+import { isNumber } from 'topgun-typed';
+import { TGGraphData, TGGraphSummary, TGNode, TGNodeSummary } from '../types';
+
+const FNV_OFFSET = 0x811c9dc5;
+const FNV_PRIME  = 0x01000193;
+
+/**
+ * Max state, count and hash of the node fields with a state up to `maxState`.
+ * The hash is a sum of per field hashes, so it does not depend on key order
+ */
+export function summarizeNode(node: TGNode|undefined|null, maxState = Infinity): TGNodeSummary
+{
+    const states = (node && node._ && node._['>']) || {};
+    let max      = 0;
+    let count    = 0;
+    let hash     = 0;
+
+    for (const key in states)
+    {
+        const state = states[key];
+
+        if (!key || !isNumber(state) || state > maxState)
+        {
+            continue;
+        }
+
+        max  = Math.max(max, state);
+        hash = (hash + fieldHash(key, state, node[key])) >>> 0;
+        count++;
+    }
+
+    return [max, count, hash];
+}
+
+/**
+ * Leave out the fields the requester already holds.
+ *
+ * A node is reduced to the fields newer than the summarized max state, when the fields
+ * up to that state match the summary. Otherwise the requester misses older fields
+ * and gets the whole node
+ */
+export function filterGraphBySummary(graph: TGGraphData, summary: TGGraphSummary|undefined): TGGraphData
+{
+    if (!summary)
+    {
+        return graph;
+    }
+
+    const result: TGGraphData = {};
+
+    for (const soul in graph)
+    {
+        const node  = graph[soul];
+        const known = summary[soul];
+
+        result[soul] = node && isNodeSummary(known) && isSummaryMatch(node, known)
+            ? nodeFieldsAfter(node, known[0])
+            : node;
+    }
+
+    return result;
+}
+
+function isNodeSummary(value: unknown): value is TGNodeSummary
+{
+    return Array.isArray(value) && value.length === 3 && value.every(isNumber);
+}
+
+function isSummaryMatch(node: TGNode, known: TGNodeSummary): boolean
+{
+    const [, count, hash] = summarizeNode(node, known[0]);
+    return count === known[1] && hash === known[2];
+}
+
+function nodeFieldsAfter(node: TGNode, maxState: number): TGNode
+{
+    const states         = node._['>'] || {};
+    const result: TGNode = { _: { '#': node._['#'], '>': {} } };
+
+    for (const key in states)
+    {
+        if (key && states[key] > maxState)
+        {
+            result[key]        = node[key];
+            result._['>'][key] = states[key];
+        }
+    }
+
+    return result;
+}
+
+/**
+ * 32 bit FNV-1a over key, state and serialized value
+ */
+function fieldHash(key: string, state: number, value: unknown): number
+{
+    const text = `${key}\u0000${state}\u0000${JSON.stringify(value)}`;
+    let hash   = FNV_OFFSET;
+
+    for (let i = 0; i < text.length; i++)
+    {
+        hash ^= text.charCodeAt(i);
+        hash  = Math.imul(hash, FNV_PRIME);
+    }
+
+    return hash >>> 0;
+}
@@ -0,0 +1,498 @@
+import { createReadStream, promises as fs } from 'fs';
+import { join } from 'path';
+import { createInterface } from 'readline';
+import { isNumber } from 'topgun-typed';
+import { MemoryStorage } from '../memory-adapter/memory-storage';
+import { StorageListOptions } from '../storage';
+import { TGGraphData, TGNode } from '../types';
+import { mergeGraphInPlace } from '../crdt';
+
+export interface FileSystemStorageOptions
+{
+    /** Longest time in ms a write waits to be committed with others, 0 (default) commits the writes of a tick together */
+    commitWindow?: number;
+    /** Log size in bytes after which the log is compacted into a new snapshot, 64 MiB by default */
+    compactThreshold?: number;
+    /** Flush every commit to disk before acknowledging it, enabled by default */
+    fsync?: boolean;
+}
+
+interface FileSystemCommit
+{
+    readonly lines: string[];
+    readonly promise: Promise<void>;
+    readonly resolve: () => void;
+    readonly reject: (error: unknown) => void;
+}
+
+const SNAPSHOT_FILE       = 'snapshot.jsonl';
+const LOG_FILE_PATTERN    = /^log-(\d+)\.jsonl$/;
+const DEFAULT_COMPACT_AT  = 64 * 1024 * 1024;
+const SNAPSHOT_CHUNK_SIZE = 1024 * 1024;
+
+/**
+ * Durable storage keeping all nodes in memory, backed by a snapshot and an append-only log.
+ *
+ * Writes update memory at once and are appended to the log, all writes of a commit window
+ * share one write and one fsync. A put resolves once its commit is on disk. Writes of the graph adapter
+ * log the CRDT diff of the put rather than the merged nodes.
+ * When the log outgrows `compactThreshold` the nodes are written sorted by soul to a new snapshot,
+ * one `[soul, node]` JSON line each, and the older logs are removed.
+ * Opening the directory loads the snapshot and merges the records of the logs written after it
+ */
+export class FileSystemStorage extends MemoryStorage
+{
+    readonly directory: string;
+    readonly options: FileSystemStorageOptions;
+
+    private readonly _ready: Promise<void>;
+    private _generation: number;
+    private _log: fs.FileHandle|null;
+    private _logSize: number;
+    private _commit: FileSystemCommit|null;
+    /** Commits and compactions run one after another */
+    private _chain: Promise<void>;
+    private _compacting: boolean;
+
+    /**
+     * Constructor
+     */
+    constructor(directory: string, options?: FileSystemStorageOptions)
+    {
+        super();
+        this.directory   = directory;
+        this.options     = options || {};
+        this._generation = 0;
+        this._log        = null;
+        this._logSize    = 0;
+        this._commit     = null;
+        this._compacting = false;
+        this._ready      = this._load();
+        this._chain      = this._ready;
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Resolves once the snapshot and the logs are loaded
+     */
+    ready(): Promise<void>
+    {
+        return this._ready;
+    }
+
+    async get(key: string): Promise<TGNode>
+    {
+        await this._ready;
+        return super.get(key);
+    }
+
+    async getMany(keys: string[]): Promise<TGGraphData>
+    {
+        await this._ready;
+        return super.getMany(keys);
+    }
+
+    async list(options: StorageListOptions): Promise<TGGraphData>
+    {
+        await this._ready;
+        return super.list(options);
+    }
+
+    async put(key: string, value: TGNode): Promise<void>
+    {
+        return this.putMany({ [key]: value });
+    }
+
+    async putMany(data: TGGraphData): Promise<void>
+    {
+        await this._ready;
+
+        const record: TGGraphData = {};
+        let empty                 = true;
+
+        for (const key in data)
+        {
+            if (data[key])
+            {
+                this.putSync(key, data[key]);
+                record[key] = data[key];
+                empty       = false;
+            }
+        }
+
+        // Serialized now, merges change stored nodes in place
+        return empty ? undefined : this._append(JSON.stringify(record));
+    }
+
+    /**
+     * Store merged nodes and log only the diff that produced them
+     */
+    async putDiff(nodes: TGGraphData, diff: TGGraphData): Promise<void>
+    {
+        await this._ready;
+
+        for (const key in nodes)
+        {
+            if (nodes[key])
+            {
+                this.putSync(key, nodes[key]);
+            }
+        }
+
+        return this._append(JSON.stringify(diff));
+    }
+
+    /**
+     * Write all nodes to a new snapshot and drop the logs it covers
+     */
+    async compact(): Promise<void>
+    {
+        await this._ready;
+        return this._enqueue(() => this._compact());
+    }
+
+    /**
+     * Commit pending writes and close the log
+     */
+    async close(): Promise<void>
+    {
+        await this._ready;
+        this._flush();
+        await this._chain;
+
+        if (this._log)
+        {
+            await this._log.close();
+            this._log = null;
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    private async _load(): Promise<void>
+    {
+        await fs.mkdir(this.directory, { recursive: true });
+
+        const files       = await fs.readdir(this.directory);
+        const snapshotGen = await this._readSnapshot(files.includes(SNAPSHOT_FILE));
+        const logs        = files
+            .map(file => LOG_FILE_PATTERN.exec(file))
+            .filter(match => !!match)
+            .map(match => parseInt(match[1], 10))
+            .sort((a, b) => a - b);
+
+        for (const generation of logs)
+        {
+            if (generation >= snapshotGen)
+            {
+                await this._replayLog(generation);
+            }
+        }
+
+        this._generation = Math.max(snapshotGen, logs.length ? logs[logs.length - 1] : 0);
+        await this._openLog();
+    }
+
+    /**
+     * @returns The log generation the snapshot was taken at
+     */
+    private async _readSnapshot(exists: boolean): Promise<number>
+    {
+        if (!exists)
+        {
+            return 0;
+        }
+
+        let generation = 0;
+        let header     = true;
+
+        await this._readLines(SNAPSHOT_FILE, (line) =>
+        {
+            const value = JSON.parse(line);
+
+            if (header)
+            {
+                generation = isNumber(value?.generation) ? value.generation : 0;
+                header     = false;
+            }
+            else
+            {
+                this.putSync(value[0], value[1]);
+            }
+        });
+
+        return generation;
+    }
+
+    private async _replayLog(generation: number): Promise<void>
+    {
+        const file  = logFileName(generation);
+        const valid = await this._readLines(file, (line) =>
+        {
+            const record: TGGraphData = JSON.parse(line);
+            const existing            = {} as TGGraphData;
+
+            for (const key in record)
+            {
+                existing[key] = this.map.get(key);
+            }
+
+            // Logged states were accepted when written, none of them is rejected as future state
+            mergeGraphInPlace(existing, record, { machineState: Infinity });
+
+            for (const key in existing)
+            {
+                if (existing[key])
+                {
+                    this.putSync(key, existing[key]);
+                }
+            }
+        });
+
+        // Records appended later must not continue the torn line
+        const path = join(this.directory, file);
+
+        if (valid < (await fs.stat(path)).size)
+        {
+            await fs.truncate(path, valid);
+        }
+    }
+
+    /**
+     * Call back for every complete line, a torn line left by a crash ends the file
+     *
+     * @returns The size in bytes of the complete lines
+     */
+    private async _readLines(file: string, onLine: (line: string) => void): Promise<number>
+    {
+        const path  = join(this.directory, file);
+        const size  = (await fs.stat(path)).size;
+        const lines = createInterface({
+            input    : createReadStream(path, { encoding: 'utf8' }),
+            crlfDelay: Infinity,
+        });
+        let valid   = 0;
+
+        for await (const line of lines)
+        {
+            // The last line may lack its newline
+            const end = Math.min(valid + Buffer.byteLength(line) + 1, size);
+
+            if (line)
+            {
+                try
+                {
+                    onLine(line);
+                }
+                catch (e)
+                {
+                    console.warn(`Ignoring the rest of ${file} after an incomplete record`);
+                    lines.close();
+                    break;
+                }
+            }
+
+            valid = end;
+        }
+
+        return valid;
+    }
+
+    private async _openLog(): Promise<void>
+    {
+        const path    = join(this.directory, logFileName(this._generation));
+        this._log     = await fs.open(path, 'a+');
+        this._logSize = (await this._log.stat()).size;
+
+        if (this._logSize > 0)
+        {
+            const last = Buffer.alloc(1);
+
+            await this._log.read(last, 0, 1, this._logSize - 1);
+
+            // A complete record written without its newline
+            if (last[0] !== 0x0a)
+            {
+                await this._log.write('\n');
+                this._logSize++;
+            }
+        }
+    }
+
+    private _append(line: string): Promise<void>
+    {
+        if (!this._commit)
+        {
+            this._commit = createCommit();
+
+            const window = this.options.commitWindow;
+
+            if (isNumber(window) && window > 0)
+            {
+                setTimeout(() => this._flush(), window);
+            }
+            else
+            {
+                Promise.resolve().then(() => this._flush());
+            }
+        }
+
+        this._commit.lines.push(line);
+        return this._commit.promise;
+    }
+
+    /**
+     * Hand the open commit over to the write chain
+     */
+    private _flush(): void
+    {
+        const commit = this._commit;
+
+        if (!commit)
+        {
+            return;
+        }
+
+        this._commit = null;
+        this._enqueue(() => this._write(commit)).then(commit.resolve, commit.reject);
+    }
+
+    private _enqueue(task: () => Promise<void>): Promise<void>
+    {
+        const result = this._chain.then(task);
+
+        // A failed task is reported to its callers, later tasks still run
+        this._chain = result.catch(() => undefined);
+        return result;
+    }
+
+    private async _write(commit: FileSystemCommit): Promise<void>
+    {
+        const data = commit.lines.join('\n') + '\n';
+
+        await this._log.write(data);
+        if (this.options.fsync !== false)
+        {
+            await this._log.sync();
+        }
+        this._logSize += Buffer.byteLength(data);
+
+        const threshold = isNumber(this.options.compactThreshold) ? this.options.compactThreshold : DEFAULT_COMPACT_AT;
+
+        if (this._logSize >= threshold && !this._compacting)
+        {
+            this._compacting = true;
+            this._enqueue(() => this._compact()).catch((e) =>
+            {
+                console.warn('Log compaction failed', e);
+            });
+        }
+    }
+
+    private async _compact(): Promise<void>
+    {
+        this._compacting = true;
+
+        try
+        {
+            // Later writes go to a new log, replayed on top of the snapshot
+            const generation = this._generation + 1;
+            const keys       = [...this.index.range({})];
+
+            await this._log.close();
+            this._generation = generation;
+            await this._openLog();
+
+            await this._writeSnapshot(generation, keys);
+
+            const files = await fs.readdir(this.directory);
+
+            for (const file of files)
+            {
+                const match = LOG_FILE_PATTERN.exec(file);
+
+                if (match && parseInt(match[1], 10) < generation)
+                {
+                    await fs.unlink(join(this.directory, file));
+                }
+            }
+        }
+        finally
+        {
+            this._compacting = false;
+        }
+    }
+
+    private async _writeSnapshot(generation: number, keys: string[]): Promise<void>
+    {
+        const tmpPath = join(this.directory, `${SNAPSHOT_FILE}.tmp`);
+        const file    = await fs.open(tmpPath, 'w');
+
+        try
+        {
+            let chunk = JSON.stringify({ generation }) + '\n';
+
+            for (const key of keys)
+            {
+                chunk += JSON.stringify([key, this.map.get(key)]) + '\n';
+
+                if (chunk.length >= SNAPSHOT_CHUNK_SIZE)
+                {
+                    await file.write(chunk);
+                    chunk = '';
+                }
+            }
+
+            await file.write(chunk);
+            await file.sync();
+        }
+        finally
+        {
+            await file.close();
+        }
+
+        await fs.rename(tmpPath, join(this.directory, SNAPSHOT_FILE));
+        await syncDirectory(this.directory);
+    }
+}
+
+function logFileName(generation: number): string
+{
+    return `log-${String(generation).padStart(6, '0')}.jsonl`;
+}
+
+function createCommit(): FileSystemCommit
+{
+    let resolve: () => void;
+    let reject: (error: unknown) => void;
+
+    const promise = new Promise<void>((res, rej) =>
+    {
+        resolve = res;
+        reject  = rej;
+    });
+
+    return { lines: [], promise, resolve, reject };
+}
+
+/**
+ * Persist a rename, not supported on every platform
+ */
+async function syncDirectory(directory: string): Promise<void>
+{
+    try
+    {
+        const handle = await fs.open(directory, 'r');
+        await handle.sync();
+        await handle.close();
+    }
+    catch (e)
+    {
+        // Directories cannot be opened for syncing on Windows
+    }
+}
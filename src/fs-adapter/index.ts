@@ -0,0 +1,21 @@
+import { TGGraphAdapter, TGGraphAdapterOptions } from '../types';
+import { createGraphAdapter } from '../storage/adapter';
+import { FileSystemStorage, FileSystemStorageOptions } from './file-system-storage';
+
+export function createFileSystemAdapter(
+    directory: string,
+    adapterOptions?: TGGraphAdapterOptions,
+    storageOptions?: FileSystemStorageOptions,
+): TGGraphAdapter
+{
+    const storage = new FileSystemStorage(directory, storageOptions);
+    const adapter = createGraphAdapter(storage, adapterOptions);
+
+    return {
+        ...adapter,
+        // Resolves once the last commit is on disk
+        close: () => storage.close(),
+    };
+}
+
+export * from './file-system-storage';
@@ -1,10 +1,20 @@
 import { TGGraphAdapter, TGGraphAdapterOptions } from '../types';
-import { IndexedDBStorage } from './indexeddb-storage';
+import { IndexedDBStorage, IndexedDBStorageOptions } from './indexeddb-storage';
 import { createGraphAdapter } from '../storage/adapter';
 
 const DEFAULT_DB_NAME = 'topgun-nodes';
 
-export function createIndexedDBAdapter(name = DEFAULT_DB_NAME, adapterOptions?: TGGraphAdapterOptions): TGGraphAdapter
+export function createIndexedDBAdapter(
+    name = DEFAULT_DB_NAME,
+    adapterOptions?: TGGraphAdapterOptions,
+    storageOptions?: IndexedDBStorageOptions,
+): TGGraphAdapter
 {
-    return createGraphAdapter(new IndexedDBStorage(name), adapterOptions);
+    const storage = new IndexedDBStorage(name, storageOptions);
+    const adapter = createGraphAdapter(storage, adapterOptions);
+
+    return {
+        ...adapter,
+        close: () => storage.close(),
+    };
 }
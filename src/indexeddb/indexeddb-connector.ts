@@ -1,11 +1,20 @@
 import { createIndexedDBAdapter } from './indexeddb-adapter';
+import { IndexedDBStorageOptions } from './indexeddb-storage';
 import { TGGraphConnectorFromAdapter } from '../client/transports/graph-connector-from-adapter';
 import { TGGraphAdapterOptions } from '../types';
 
 export class TGIndexedDBConnector extends TGGraphConnectorFromAdapter
 {
-    constructor(storageKey?: string, adapterOptions?: TGGraphAdapterOptions)
+    constructor(storageKey?: string, adapterOptions?: TGGraphAdapterOptions, storageOptions?: IndexedDBStorageOptions)
     {
-        super(createIndexedDBAdapter(storageKey, adapterOptions), 'TGIndexedDBConnector');
+        super(createIndexedDBAdapter(storageKey, adapterOptions, storageOptions), 'TGIndexedDBConnector');
+    }
+
+    /**
+     * Commit buffered puts and close the database
+     */
+    async disconnect(): Promise<void>
+    {
+        await this.adapter.close?.();
     }
 }
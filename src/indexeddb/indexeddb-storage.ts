@@ -1,21 +1,62 @@
+import { isNumber } from 'topgun-typed';
 import { StorageListOptions, TGStorage } from '../storage';
-import { arrayNodesToObject, filterNodesByListOptions } from '../storage/utils';
+import { createListFilter } from '../storage/utils';
 import { TGGraphData, TGNode } from '../types';
+import { mergeNodes } from '../crdt';
+import { isBrowser } from '../utils/is-browser';
+
+export interface IndexedDBStorageOptions
+{
+    /**
+     * Longest time in ms a put may wait in the write-behind buffer before it is committed.
+     * Puts within the window are coalesced per soul and written in one transaction.
+     * 0 (default) flushes on the next microtask
+     */
+    maxWriteLatency?: number;
+    /** Commit buffered puts as soon as the page becomes hidden, enabled by default */
+    flushOnHide?: boolean;
+}
+
+interface IndexedDBWriteBatch
+{
+    readonly writes: Map<string, TGNode>;
+    readonly promise: Promise<void>;
+    readonly resolve: () => void;
+    readonly reject: (error: unknown) => void;
+}
 
 export class IndexedDBStorage implements TGStorage
 {
     private _dbp: Promise<IDBDatabase>|undefined;
+    private _batch: IndexedDBWriteBatch|null;
+    private _onVisibilityChange: (() => void)|null;
     readonly _dbName: string;
     readonly _storeName: string;
+    readonly _options: IndexedDBStorageOptions;
 
     /**
      * Constructor
      */
-    constructor(storeName: string)
+    constructor(storeName: string, options?: IndexedDBStorageOptions)
     {
         this._dbName    = storeName;
         this._storeName = storeName;
+        this._options   = options || {};
+        this._batch     = null;
         this._init();
+
+        this._onVisibilityChange = null;
+        if (this._options.flushOnHide !== false && isBrowser())
+        {
+            this._onVisibilityChange = () =>
+            {
+                if (document.visibilityState === 'hidden')
+                {
+                    this.flush();
+                }
+            };
+            document.addEventListener('visibilitychange', this._onVisibilityChange);
+        }
     }
 
     // -----------------------------------------------------------------------------------------------------
@@ -24,40 +65,134 @@ export class IndexedDBStorage implements TGStorage
 
     get(key: IDBValidKey): Promise<TGNode>
     {
+        const pending = this._batch && this._batch.writes.get(key as string);
+
+        if (pending)
+        {
+            return Promise.resolve(pending);
+        }
+
         let req: IDBRequest;
-        return this._withIDBStore('readwrite', (store) =>
+        return this._withIDBStore('readonly', (store) =>
         {
             req = store.get(key);
         }).then(() => req.result);
     }
 
+    /**
+     * Walks a bounded cursor and stops after `limit` matches.
+     * IndexedDB orders string keys by UTF-16 code units, which only differs from
+     * UTF-8 order when astral characters are compared with U+E000..U+FFFF
+     */
     async list(options: StorageListOptions): Promise<TGGraphData>
     {
-        const allNodes = await this.getAll();
-        const nodes    = filterNodesByListOptions(allNodes, options);
+        const result: TGGraphData = {};
+        const max                 = isNumber(options?.limit) ? options.limit : Infinity;
+        const range               = keyRangeFromListOptions(options);
+        const filter              = createListFilter(options);
 
-        return arrayNodesToObject(nodes);
+        if (max <= 0 || range === null)
+        {
+            return result;
+        }
+
+        let count = 0;
+
+        await this.flush();
+        return this._withIDBStore('readonly', (store) =>
+        {
+            const req     = store.openCursor(range, options?.reverse ? 'prev' : 'next');
+            req.onsuccess = () =>
+            {
+                const cursor = req.result;
+
+                if (!cursor)
+                {
+                    return;
+                }
+
+                const key = cursor.key as string;
+
+                if (filter(key))
+                {
+                    result[key] = cursor.value;
+                    count++;
+                }
+                if (count < max)
+                {
+                    cursor.continue();
+                }
+            };
+        }).then(() => result);
     }
 
     put(key: IDBValidKey, value: any): Promise<void>
     {
-        return this._withIDBStore('readwrite', (store) =>
+        return this._bufferWrite(key as string, value);
+    }
+
+    getMany(keys: string[]): Promise<TGGraphData>
+    {
+        const result: TGGraphData = {};
+        const pending             = this._batch && this._batch.writes;
+        const missing             = pending ? keys.filter(key => !pending.has(key)) : keys;
+
+        if (pending)
         {
-            store.put(value, key);
-        });
+            keys.forEach((key) =>
+            {
+                if (pending.has(key))
+                {
+                    result[key] = pending.get(key);
+                }
+            });
+        }
+        if (!missing.length)
+        {
+            return Promise.resolve(result);
+        }
+
+        return this._withIDBStore('readonly', (store) =>
+        {
+            missing.forEach((key) =>
+            {
+                const req     = store.get(key);
+                req.onsuccess = () =>
+                {
+                    result[key] = req.result || null;
+                };
+            });
+        }).then(() => result);
+    }
+
+    putMany(data: TGGraphData): Promise<void>
+    {
+        let promise = Promise.resolve();
+
+        for (const key in data)
+        {
+            if (data[key])
+            {
+                promise = this._bufferWrite(key, data[key]);
+            }
+        }
+
+        return promise;
     }
 
-    getAll(): Promise<TGNode[]>
+    async getAll(): Promise<TGNode[]>
     {
         let req: IDBRequest;
-        return this._withIDBStore('readwrite', (store) =>
+        await this.flush();
+        return this._withIDBStore('readonly', (store) =>
         {
             req = store.getAll();
         }).then(() => req.result);
     }
 
-    update(key: IDBValidKey, updater: (val: any) => any): Promise<void>
+    async update(key: IDBValidKey, updater: (val: any) => any): Promise<void>
     {
+        await this.flush();
         return this._withIDBStore('readwrite', (store) =>
         {
             const req     = store.get(key);
@@ -68,10 +203,105 @@ export class IndexedDBStorage implements TGStorage
         });
     }
 
+    /**
+     * Commit all buffered puts in one transaction
+     */
+    flush(): Promise<void>
+    {
+        const batch = this._batch;
+
+        if (!batch)
+        {
+            return Promise.resolve();
+        }
+
+        this._batch = null;
+        this._withIDBStore('readwrite', (store) =>
+        {
+            batch.writes.forEach((value, key) =>
+            {
+                store.put(value, key);
+            });
+        }).then(batch.resolve, batch.reject);
+
+        return batch.promise;
+    }
+
+    /**
+     * Commit buffered puts, stop listening to the page and close the database
+     */
+    async close(): Promise<void>
+    {
+        if (this._onVisibilityChange)
+        {
+            document.removeEventListener('visibilitychange', this._onVisibilityChange);
+            this._onVisibilityChange = null;
+        }
+        if (!this._dbp)
+        {
+            return;
+        }
+
+        await this.flush();
+
+        const db = await this._dbp;
+        this._dbp = undefined;
+        db.close();
+    }
+
     // -----------------------------------------------------------------------------------------------------
     // @ Private methods
     // -----------------------------------------------------------------------------------------------------
 
+    private _bufferWrite(key: string, value: TGNode): Promise<void>
+    {
+        if (!this._batch)
+        {
+            this._batch = this._createBatch();
+        }
+
+        const writes = this._batch.writes;
+        writes.set(key, mergeNodes(writes.get(key), value));
+
+        return this._batch.promise;
+    }
+
+    private _createBatch(): IndexedDBWriteBatch
+    {
+        let resolve: () => void;
+        let reject: (error: unknown) => void;
+
+        const promise                    = new Promise<void>((res, rej) =>
+        {
+            resolve = res;
+            reject  = rej;
+        });
+        const batch: IndexedDBWriteBatch = { writes: new Map(), promise, resolve, reject };
+
+        // Errors are reported to the callers of put, avoid unhandled rejections for the timer flush
+        batch.promise.catch(() => undefined);
+
+        const flushBatch = () =>
+        {
+            if (this._batch === batch)
+            {
+                this.flush();
+            }
+        };
+        const latency    = this._options.maxWriteLatency;
+
+        if (isNumber(latency) && latency > 0)
+        {
+            setTimeout(flushBatch, latency);
+        }
+        else
+        {
+            Promise.resolve().then(flushBatch);
+        }
+
+        return batch;
+    }
+
     private _init(): void
     {
         if (this._dbp)
@@ -123,3 +353,61 @@ export class IndexedDBStorage implements TGStorage
         );
     }
 }
+
+/**
+ * Smallest key range covering the list options, null when nothing can match
+ */
+function keyRangeFromListOptions(options?: StorageListOptions): IDBKeyRange|undefined|null
+{
+    const prefix = options?.prefix;
+    let lower    = options?.start;
+    let upper    = options?.end;
+
+    if (prefix)
+    {
+        const prefixEnd = prefixSuccessor(prefix);
+
+        if (lower === undefined || lower < prefix)
+        {
+            lower = prefix;
+        }
+        if (prefixEnd !== undefined && (upper === undefined || prefixEnd < upper))
+        {
+            upper = prefixEnd;
+        }
+    }
+
+    if (lower !== undefined && upper !== undefined)
+    {
+        return lower < upper ? IDBKeyRange.bound(lower, upper, false, true) : null;
+    }
+    if (lower !== undefined)
+    {
+        return IDBKeyRange.lowerBound(lower);
+    }
+    if (upper !== undefined)
+    {
+        return IDBKeyRange.upperBound(upper, true);
+    }
+
+    return undefined;
+}
+
+/**
+ * First string after every string that starts with the prefix
+ */
+function prefixSuccessor(prefix: string): string|undefined
+{
+    let end = prefix.length;
+
+    while (end > 0 && prefix.charCodeAt(end - 1) === 0xffff)
+    {
+        end--;
+    }
+    if (end === 0)
+    {
+        return undefined;
+    }
+
+    return prefix.slice(0, end - 1) + String.fromCharCode(prefix.charCodeAt(end - 1) + 1);
+}
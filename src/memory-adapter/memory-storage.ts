@@ -1,30 +1,27 @@
-import { isNumber } from 'topgun-typed';
 import { TGGraphData, TGNode } from '../types';
 import { StorageListOptions, TGStorage } from '../storage';
-import { lexicographicCompare, listFilterMatch } from '../storage/utils';
+import { SortedKeyIndex } from '../storage/sorted-key-index';
 
 export class MemoryStorage implements TGStorage
 {
+    protected readonly index: SortedKeyIndex;
+
     constructor(
         protected map = new Map<string, TGNode>(),
     )
     {
+        this.index = new SortedKeyIndex(this.map.keys());
     }
 
     list(options: StorageListOptions): Promise<TGGraphData>
     {
-        const direction = options?.reverse ? -1 : 1;
-        let keys        = Array.from(this.map.keys())
-            .filter(key => listFilterMatch(options, key))
-            .sort((a, b) => direction * lexicographicCompare(a, b));
+        const result: TGGraphData = {};
 
-        if (isNumber(options?.limit) && keys.length > options?.limit)
+        for (const key of this.index.range(options))
         {
-            keys = keys.slice(0, options.limit);
+            result[key] = this.map.get(key);
         }
 
-        const result = keys.reduce((accum: TGGraphData, key: string) => ({ ...accum, [key]: this.map.get(key) }), {});
-
         return Promise.resolve(result);
     }
 
@@ -38,8 +35,37 @@ export class MemoryStorage implements TGStorage
         return Promise.resolve(this.getSync(key));
     }
 
+    getMany(keys: string[]): Promise<TGGraphData>
+    {
+        const result: TGGraphData = {};
+
+        for (const key of keys)
+        {
+            result[key] = this.getSync(key);
+        }
+
+        return Promise.resolve(result);
+    }
+
+    putMany(data: TGGraphData): Promise<void>
+    {
+        for (const key in data)
+        {
+            if (data[key])
+            {
+                this.putSync(key, data[key]);
+            }
+        }
+
+        return Promise.resolve();
+    }
+
     putSync(key: string, value: TGNode): void
     {
+        if (!this.map.has(key))
+        {
+            this.index.add(key);
+        }
         this.map.set(key, value);
     }
 
@@ -0,0 +1,91 @@
+import WebCrypto from 'topgun-webcrypto';
+import { ecdsa, jwk } from './settings';
+import { LRUCache } from '../utils/lru-cache';
+
+/** Maximum number of imported ECDSA keys kept in memory */
+export const ECDSA_KEY_CACHE_SIZE = 1000;
+
+interface TGSignKeyEntry
+{
+    readonly priv: string;
+    readonly key: Promise<CryptoKey>;
+}
+
+const verifyKeys = new LRUCache<string, Promise<CryptoKey>>(ECDSA_KEY_CACHE_SIZE);
+/** One key per pub, a different priv for the pub replaces it */
+const signKeys   = new LRUCache<string, TGSignKeyEntry>(ECDSA_KEY_CACHE_SIZE);
+
+/**
+ * Import the public key of a pair for verifying, imports are cached per pub
+ */
+export function importVerifyKey(pub: string): Promise<CryptoKey>
+{
+    return cachedImport(verifyKeys, pub, () =>
+        WebCrypto.subtle.importKey('jwk', jwk(pub), ecdsa.pair, false, ['verify']),
+    );
+}
+
+/**
+ * Import the private key of a pair for signing, imports are cached per pub
+ */
+export function importSignKey(pub: string, priv: string): Promise<CryptoKey>
+{
+    const entry = signKeys.get(pub);
+
+    if (entry && entry.priv === priv)
+    {
+        return entry.key;
+    }
+
+    const key = WebCrypto.subtle.importKey('jwk', jwk(pub, priv), ecdsa.pair, false, ['sign']);
+
+    signKeys.set(pub, { priv, key });
+    key.catch(() =>
+    {
+        if (signKeys.get(pub)?.key === key)
+        {
+            signKeys.delete(pub);
+        }
+    });
+
+    return key;
+}
+
+/**
+ * Forget the signing key of a pub, called when its user logs out
+ */
+export function clearSignKey(pub: string): void
+{
+    signKeys.delete(pub);
+}
+
+export function clearEcdsaKeyCache(): void
+{
+    verifyKeys.clear();
+    signKeys.clear();
+}
+
+function cachedImport(
+    cache: LRUCache<string, Promise<CryptoKey>>,
+    cacheKey: string,
+    importKey: () => Promise<CryptoKey>,
+): Promise<CryptoKey>
+{
+    let promise = cache.get(cacheKey);
+
+    if (!promise)
+    {
+        // Concurrent callers share one import, a failed import is not cached
+        promise = importKey();
+        cache.set(cacheKey, promise);
+        promise.catch(() =>
+        {
+            if (cache.get(cacheKey) === promise)
+            {
+                cache.delete(cacheKey);
+            }
+        });
+    }
+
+    return promise;
+}
@@ -14,5 +14,6 @@ export { pubFromSoul } from './soul';
 export { certify } from './certify';
 export { secret } from './secret';
 export { createPolicy, Policy } from './policy';
-export { verify, verifySignature, verifyHashSignature } from './verify';
+export { verify, verifySignature, verifyHashSignature, verifyMany } from './verify';
+export { importSignKey, importVerifyKey, clearEcdsaKeyCache, clearSignKey } from './import-ecdsa-key';
 
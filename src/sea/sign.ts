@@ -1,10 +1,12 @@
 import Buffer from 'topgun-buffer';
 import WebCrypto from 'topgun-webcrypto';
 import { isString, isObject, isUndefined } from 'topgun-typed';
-import { check, ecdsa, jwk, parse } from './settings';
+import { check, ecdsa, parse } from './settings';
 import { sha256 } from './sha256';
 import { pubFromSoul } from './soul';
-import { verify, VerifyData } from './verify';
+import { verify, verifyMany, VerifyData, VERIFY_CONCURRENCY } from './verify';
+import { importSignKey } from './import-ecdsa-key';
+import { mapConcurrent } from '../utils/map-concurrent';
 import { TGGraphData, TGNode, TGOptionsPut, TGValue } from '../types';
 import { TGClient, TGLink } from '../client';
 import { Policy } from './policy';
@@ -170,16 +172,8 @@ export async function signHash(
     encoding = DEFAULT_OPTS.encode,
 ): Promise<string>
 {
-    const { pub, priv } = pair;
-    const token         = jwk(pub, priv);
-    const signKey       = await WebCrypto.subtle.importKey(
-        'jwk',
-        token,
-        ecdsa.pair,
-        false,
-        ['sign'],
-    );
-    const sig           = await WebCrypto.subtle.sign(
+    const signKey = await importSignKey(pair.pub, pair.priv);
+    const sig     = await WebCrypto.subtle.sign(
         ecdsa.sign,
         signKey,
         new Uint8Array(Buffer.from(hash, 'hex')),
@@ -283,28 +277,74 @@ export async function signNodeValue(
     };
 }
 
-export async function signNode(node: TGNode, pair: PairBase): Promise<TGNode>
+/**
+ * Sign every field of a node, at most `concurrency` fields at a time
+ */
+export async function signNode(
+    node: TGNode,
+    pair: PairBase,
+    concurrency = VERIFY_CONCURRENCY,
+): Promise<TGNode>
 {
     const signedNode: TGNode = {
         _: node._,
     };
     const soul               = getNodeSoul(node);
+    const keys               = Object.keys(node).filter(key => key !== '_');
+
+    const values = await mapConcurrent(keys, concurrency, async (key) =>
+    {
+        if (key === 'pub' /*|| key === "alias"*/ && soul === `~${pair.pub}`)
+        {
+            // Special case
+            return node[key];
+        }
+        return JSON.stringify(await signNodeValue(node, key, pair));
+    });
+
+    keys.forEach((key, index) =>
+    {
+        signedNode[key] = values[index];
+    });
+
+    return signedNode;
+}
+
+/**
+ * Check the signatures of all fields of a node signed by pub
+ */
+export async function verifyNode(
+    node: TGNode,
+    pub: string,
+    concurrency = VERIFY_CONCURRENCY,
+): Promise<boolean>
+{
+    const soul                    = getNodeSoul(node) as string;
+    const fields: [string, any][] = [];
 
     for (const key in node)
     {
-        if (key === '_')
+        if (key === '_' || (key === 'pub' && soul === `~${pub}`))
         {
             continue;
         }
-        if (key === 'pub' /*|| key === "alias"*/ && soul === `~${pair.pub}`)
+
+        const signed = parse(node[key]);
+
+        if (!isObject(signed) || !isString(signed['~']))
         {
-            // Special case
-            signedNode[key] = node[key];
-            continue;
+            return false;
         }
-        signedNode[key] = JSON.stringify(await signNodeValue(node, key, pair));
+        fields.push([key, signed]);
     }
-    return signedNode;
+
+    const items = await mapConcurrent(fields, concurrency, async ([key, signed]) => ({
+        hash     : await hashForSignature(prep(signed[':'], key, node, soul)),
+        signature: signed['~'] as string,
+    }));
+
+    const results = await verifyMany(items, pub, undefined, concurrency);
+    return results.every(Boolean);
 }
 
 export async function signGraph(
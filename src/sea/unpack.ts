@@ -1,8 +1,21 @@
-import { isObject, isDefined } from 'topgun-typed';
+import { isObject, isDefined, isString } from 'topgun-typed';
 import { check, parse, shuffleAttackCutoff } from './settings';
 import { pubFromSoul } from './soul';
 import { TGGraphData, TGNode } from '../types';
 import { getNodeSoul } from '../utils/node';
+import { LRUCache } from '../utils/lru-cache';
+
+const UNPACK_CACHE_SIZE = 10000;
+
+interface TGUnpackedField
+{
+    readonly raw: string;
+    readonly state: number;
+    readonly value: any;
+}
+
+/** Unpacked signed values by soul and key, reused while the raw value and its state are unchanged */
+const unpackedFields = new LRUCache<string, TGUnpackedField>(UNPACK_CACHE_SIZE);
 
 export function unpack(passedValue: any, key: string, node: TGNode): any
 {
@@ -78,6 +91,9 @@ export function unpackNode(
                       _: node._,
                   };
 
+    const soul   = getNodeSoul(node);
+    const states = (node._ && node._['>']) || {};
+
     for (const key in node)
     {
         if (key === '_')
@@ -85,7 +101,28 @@ export function unpackNode(
             continue;
         }
 
-        result[key] = unpack(parse(node[key]), key, node);
+        const raw = node[key];
+
+        if (!isString(raw))
+        {
+            result[key] = unpack(parse(raw), key, node);
+            continue;
+        }
+
+        const cacheKey = `${soul}\u0000${key}`;
+        const state    = states[key] || 0;
+        const cached   = unpackedFields.get(cacheKey);
+
+        if (cached && cached.raw === raw && cached.state === state)
+        {
+            result[key] = cached.value;
+            continue;
+        }
+
+        const value = unpack(parse(raw), key, node);
+
+        unpackedFields.set(cacheKey, { raw, state, value });
+        result[key] = value;
     }
 
     return result;
@@ -96,6 +133,11 @@ export function unpackGraph(
     mut: 'immutable'|'mutable' = 'immutable',
 ): TGGraphData
 {
+    if (!hasUserSoul(graph))
+    {
+        return graph;
+    }
+
     const unpackedGraph: TGGraphData = mut === 'mutable' ? graph : {};
 
     for (const soul in graph)
@@ -106,10 +148,30 @@ export function unpackGraph(
         }
 
         const node = graph[soul];
-        const pub  = pubFromSoul(soul);
 
-        unpackedGraph[soul] = node && pub ? unpackNode(node, mut) : node;
+        unpackedGraph[soul] = node && isUserSoul(soul) ? unpackNode(node, mut) : node;
     }
 
     return unpackedGraph;
 }
+
+/**
+ * Only user souls hold signed values, graphs without them pass through untouched
+ */
+function hasUserSoul(graph: TGGraphData): boolean
+{
+    for (const soul in graph)
+    {
+        if (isUserSoul(soul))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+function isUserSoul(soul: string): boolean
+{
+    return !!soul && soul.indexOf('~') !== -1 && !!pubFromSoul(soul);
+}
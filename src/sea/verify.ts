@@ -1,9 +1,11 @@
 import Buffer from 'topgun-buffer';
 import WebCrypto from 'topgun-webcrypto';
 import { isObject, isString } from 'topgun-typed';
-import { ecdsa, jwk, parse } from './settings';
+import { ecdsa, parse } from './settings';
 import { sha256 } from './sha256';
 import { Pair } from './pair';
+import { importVerifyKey } from './import-ecdsa-key';
+import { mapConcurrent } from '../utils/map-concurrent';
 
 export interface VerifyData
 {
@@ -27,14 +29,8 @@ const DEFAULT_OPTS: {
     encode: 'base64',
 };
 
-function importKey(pub: string): Promise<any>
-{
-    const token   = jwk(pub);
-    const promise = WebCrypto.subtle.importKey('jwk', token, ecdsa.pair, false, [
-        'verify',
-    ]);
-    return promise;
-}
+/** Signatures verified at the same time by verifyMany */
+export const VERIFY_CONCURRENCY = 16;
 
 export async function verifyHashSignature(
     hash: string,
@@ -44,7 +40,7 @@ export async function verifyHashSignature(
 ): Promise<boolean>
 {
     const encoding = opt.encode || DEFAULT_OPTS.encode;
-    const key      = await importKey(pub);
+    const key      = await importVerifyKey(pub);
     const buf      = Buffer.from(signature, encoding);
     const sig      = new Uint8Array(buf);
 
@@ -63,6 +59,21 @@ export async function verifyHashSignature(
     return false;
 }
 
+/**
+ * Verify many hash signatures of the same pub, resolves to one result per item
+ */
+export function verifyMany(
+    items: readonly {readonly hash: string; readonly signature: string}[],
+    pub: string,
+    opt = DEFAULT_OPTS,
+    concurrency = VERIFY_CONCURRENCY,
+): Promise<boolean[]>
+{
+    return mapConcurrent(items, concurrency, ({ hash, signature }) =>
+        verifyHashSignature(hash, signature, pub, opt).catch(() => false),
+    );
+}
+
 export async function verifySignature(
     text: string,
     signature: string,
@@ -0,0 +1,140 @@
+import { TGGraphAdapter, TGMessage } from '../types';
+import { uuidv4 } from '../utils/uuidv4';
+
+export interface TGBrokerMessage
+{
+    /** Id of the server that stored the diff */
+    origin: string;
+    msg: TGMessage;
+}
+
+/**
+ * Pub/sub shared by the servers of a cluster, a Redis or NATS client can be wrapped into it
+ */
+export interface TGBroker
+{
+    publish(message: TGBrokerMessage): void|Promise<void>;
+    /** @returns A function to be called to stop the subscription */
+    subscribe(handler: (message: TGBrokerMessage) => void): () => void;
+    close?(): void|Promise<void>;
+}
+
+/**
+ * Broker for servers running in one process. Like a network broker it delivers asynchronously
+ * and hands every subscriber its own copy, adapters keep the received nodes
+ */
+export class TGMemoryBroker implements TGBroker
+{
+    private readonly _handlers: Set<(message: TGBrokerMessage) => void>;
+
+    /**
+     * Constructor
+     */
+    constructor()
+    {
+        this._handlers = new Set();
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    publish(message: TGBrokerMessage): void
+    {
+        const handlers = [...this._handlers];
+        const payload  = JSON.stringify(message);
+
+        Promise.resolve().then(() =>
+        {
+            handlers.forEach(handler => handler(JSON.parse(payload)));
+        });
+    }
+
+    subscribe(handler: (message: TGBrokerMessage) => void): () => void
+    {
+        this._handlers.add(handler);
+        return () => this._handlers.delete(handler);
+    }
+
+    close(): void
+    {
+        this._handlers.clear();
+    }
+}
+
+/**
+ * Connects the storage of one server to a broker.
+ *
+ * Diffs shared by the server are published with its origin id. Diffs of the other servers
+ * are written to the local adapter, so servers with separate storage converge,
+ * with shared storage the write finds nothing new. They are then handed to `onRemoteDiff`
+ * for delivery to local subscribers
+ */
+export class TGBrokerLink
+{
+    readonly origin: string;
+    private readonly _unsubscribe: () => void;
+    /** Remote diffs are written one after another, concurrent merges of a soul would lose writes */
+    private _writes: Promise<void>;
+
+    /**
+     * Constructor
+     */
+    constructor(
+        private readonly broker: TGBroker,
+        private readonly adapter: TGGraphAdapter,
+        private readonly onRemoteDiff: (msg: TGMessage) => void,
+    )
+    {
+        this.origin       = uuidv4();
+        this._writes      = Promise.resolve();
+        this._unsubscribe = broker.subscribe(message => this._receive(message));
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Publish a diff stored by this server
+     */
+    share(msg: TGMessage): void
+    {
+        Promise.resolve(this.broker.publish({ origin: this.origin, msg })).catch((e) =>
+        {
+            console.warn('Broker publish error', e);
+        });
+    }
+
+    close(): void
+    {
+        this._unsubscribe();
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    private _receive(message: TGBrokerMessage): void
+    {
+        if (!message || message.origin === this.origin || !message.msg || !message.msg.put)
+        {
+            return;
+        }
+
+        this._writes = this._writes.then(() => this._apply(message.msg));
+    }
+
+    private async _apply(msg: TGMessage): Promise<void>
+    {
+        try
+        {
+            await this.adapter.put(msg.put);
+            this.onRemoteDiff(msg);
+        }
+        catch (e)
+        {
+            console.warn('Broker message error', e);
+        }
+    }
+}
@@ -1,2 +1,9 @@
+export * from './broker';
+export * from './mux-hub';
+export * from './prometheus-metrics';
+export * from './publish-batcher';
 export * from './server';
 export * from './server-options';
+export * from './write-scheduler';
+export * from '../storage/sharded-adapter';
+export * from '../fs-adapter';
@@ -1,7 +1,14 @@
+import { isNumber } from 'topgun-typed';
 import { TGSocketServer, TGSocket, RequestObject } from 'topgun-socket/server';
 import { TGServerOptions } from './server-options';
-import { TGGraphAdapter, TGGraphData, TGMessage, TGOptionsGet } from '../types';
+import { TG_METRIC_GET_SECONDS, TGGraphAdapter, TGGraphData, TGMessage, TGMuxFrame, TGOptionsGet } from '../types';
 import { pseudoRandomText } from '../sea';
+import { filterGraphBySummary } from '../crdt';
+import { lexicographicCompare } from '../storage/utils';
+import { TGPublishBatcher } from './publish-batcher';
+import { TGMuxHub } from './mux-hub';
+import { TGWriteScheduler } from './write-scheduler';
+import { metricsNow, observeSince } from '../utils/metrics';
 
 export class Middleware
 {
@@ -12,6 +19,9 @@ export class Middleware
         private readonly server: TGSocketServer,
         private readonly options: TGServerOptions,
         private readonly adapter: TGGraphAdapter,
+        private readonly publishBatcher?: TGPublishBatcher,
+        private readonly muxHub?: TGMuxHub,
+        private readonly writeScheduler?: TGWriteScheduler,
     )
     {
     }
@@ -33,6 +43,50 @@ export class Middleware
         );
     }
 
+    /**
+     * Handle a frame of a multiplexed socket, replies are sent through the mux hub
+     */
+    processMuxFrame(socket: TGSocket, frame: TGMuxFrame): void
+    {
+        if (!this.muxHub || !frame)
+        {
+            return;
+        }
+
+        const muxHub = this.muxHub;
+
+        (frame.off || []).forEach(msgId => muxHub.unsubscribe(socket, msgId));
+        (frame.msgs || []).forEach((msg) =>
+        {
+            const msgId = msg && msg['#'];
+
+            if (!msgId)
+            {
+                return;
+            }
+
+            if (msg.get)
+            {
+                const soul = msg.get['#'];
+
+                if (soul && soul !== 'changelog')
+                {
+                    muxHub.subscribe(socket, msgId, soul);
+                }
+
+                this.sendPages(msg.get, reply => muxHub.send(socket, {
+                    '#': pseudoRandomText(),
+                    '@': msgId,
+                    ...reply,
+                }));
+            }
+            else if (msg.put)
+            {
+                this.processPut(msg, socket).then(reply => muxHub.send(socket, reply));
+            }
+        });
+    }
+
     // -----------------------------------------------------------------------------------------------------
     // @ Private methods
     // -----------------------------------------------------------------------------------------------------
@@ -46,7 +100,7 @@ export class Middleware
             return;
         }
 
-        this.processPut(msg).then((data) =>
+        this.processPut(msg, req.socket).then((data) =>
         {
             req.socket.transmit('#publish', {
                 channel: `topgun/@${msg['#']}`,
@@ -69,50 +123,123 @@ export class Middleware
             return;
         }
 
-        const opts  = req.data as TGOptionsGet|undefined;
-        const msgId = Math.random()
-            .toString(36)
-            .slice(2);
+        if (this.publishBatcher)
+        {
+            this.publishBatcher.addSubscriber(soul, req.socket);
+        }
+
+        const opts = req.data as TGOptionsGet|undefined;
+
+        this.sendPages(opts, (reply) =>
+        {
+            const msgId = Math.random()
+                .toString(36)
+                .slice(2);
 
-        this.readNodes(opts)
-            .then(graphData => ({
+            req.socket.transmit('#publish', {
                 channel: req.channel,
-                data   : {
-                    '#'  : msgId,
-                    'put': graphData
-                }
-            }))
-            .catch((e) =>
+                data   : reply.err
+                    ? { '#': msgId, '@': req['#'], ...reply }
+                    : { '#': msgId, ...reply },
+            });
+        });
+    }
+
+    /**
+     * Answer a get page by page, an error ends the reply
+     */
+    private async sendPages(opts: TGOptionsGet, send: (reply: TGMessage) => void): Promise<void>
+    {
+        try
+        {
+            for await (const page of this.readPages(opts))
             {
-                // tslint:disable-next-line: no-console
-                console.warn(e.stack || e);
-                return {
-                    channel: req.channel,
-                    data   : {
-                        '#'  : msgId,
-                        '@'  : req['#'],
-                        'err': 'Error fetching node'
-                    }
-                }
-            })
-            .then((msg) =>
+                send(page);
+            }
+        }
+        catch (e)
+        {
+            // tslint:disable-next-line: no-console
+            console.warn(e.stack || e);
+            send({ err: 'Error fetching node' });
+        }
+    }
+
+    /**
+     * Read a list in pages of `listPageSize` souls. Every page but the last carries the cursor
+     * to resume after it, the scan of the next page seeks past it instead of reading the list again.
+     * A reply stopped by the requested limit keeps the cursor, when more souls follow
+     */
+    private async *readPages(opts: TGOptionsGet): AsyncGenerator<TGMessage>
+    {
+        const pageSize = this.options.listPageSize;
+
+        if (!isNumber(pageSize) || pageSize <= 0)
+        {
+            yield { put: await this.readNodes(opts) };
+            return;
+        }
+
+        const direction = opts && opts['-'] ? -1 : 1;
+        let remaining   = opts && isNumber(opts['%']) ? opts['%'] : Infinity;
+        let cursor      = opts && opts['$'];
+
+        while (true)
+        {
+            const limit     = Math.min(pageSize, remaining);
+            // One soul more tells whether another page follows
+            const graphData = await this.readNodes({ ...opts, '%': limit + 1, '$': cursor });
+            const souls     = Object.keys(graphData).sort((a, b) => direction * lexicographicCompare(a, b));
+            const more      = souls.length > limit;
+            const put       = {} as TGGraphData;
+
+            souls.slice(0, limit).forEach(soul => put[soul] = graphData[soul]);
+            remaining -= Math.min(souls.length, limit);
+            cursor     = souls[Math.min(souls.length, limit) - 1];
+
+            if (!more)
+            {
+                yield { put };
+                return;
+            }
+
+            yield { put, '$': cursor };
+
+            if (remaining <= 0)
             {
-                req.socket.transmit('#publish', msg);
-            })
+                return;
+            }
+        }
     }
 
-    private readNodes(opts: TGOptionsGet): Promise<TGGraphData>
+    /**
+     * Read the requested nodes, leaving out the fields summarized as known by the requester
+     */
+    private async readNodes(opts: TGOptionsGet): Promise<TGGraphData>
     {
-        return this.adapter.get(opts);
+        const metrics   = this.options.metrics;
+        let start       = metricsNow(metrics);
+        const graphData = await this.adapter.get(opts);
+        observeSince(metrics, TG_METRIC_GET_SECONDS, start, { stage: 'storage' });
+
+        start        = metricsNow(metrics);
+        const result = filterGraphBySummary(graphData, opts && opts['^']);
+        observeSince(metrics, TG_METRIC_GET_SECONDS, start, { stage: 'filter' });
+
+        return result;
     }
 
-    private async processPut(msg: TGMessage): Promise<TGMessage>
+    private async processPut(msg: TGMessage, socket: TGSocket): Promise<TGMessage>
     {
         const msgId = pseudoRandomText();
 
         try
         {
-            if (msg.put)
+            if (msg.put && this.writeScheduler)
+            {
+                await this.writeScheduler.schedule(socket.id, msg.put);
+            }
+            else if (msg.put)
             {
                 await this.adapter.put(msg.put);
             }
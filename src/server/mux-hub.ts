@@ -0,0 +1,218 @@
+import { TGSocket } from 'topgun-socket/server';
+import { TG_MUX_EVENT, TGGraphData, TGMessage, TGMuxFrame } from '../types';
+
+interface TGMuxSocketState
+{
+    /** Soul of every active get, by message id */
+    readonly requests: Map<string, string>;
+    /** Number of active gets per soul */
+    readonly souls: Map<string, number>;
+    /** Messages waiting for the next frame */
+    pending: TGMessage[];
+    closed: boolean;
+}
+
+/**
+ * Soul interest and outgoing frames of multiplexed sockets.
+ *
+ * Every get of a socket holds a reference on its soul until it is released,
+ * the socket receives node diffs while it holds at least one reference.
+ * Messages sent within a tick reach the socket as one frame
+ */
+export class TGMuxHub
+{
+    private readonly _sockets: WeakMap<TGSocket, TGMuxSocketState>;
+    private readonly _souls: Map<string, Set<TGSocket>>;
+
+    /**
+     * Constructor
+     */
+    constructor()
+    {
+        this._sockets = new WeakMap();
+        this._souls   = new Map();
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Take a reference on a soul for a get request, repeated request ids are counted once
+     */
+    subscribe(socket: TGSocket, msgId: string, soul: string): TGMuxHub
+    {
+        const state = this._state(socket);
+
+        if (state.closed || state.requests.has(msgId))
+        {
+            return this;
+        }
+
+        const count = state.souls.get(soul) || 0;
+
+        state.requests.set(msgId, soul);
+        state.souls.set(soul, count + 1);
+
+        if (!count)
+        {
+            const sockets = this._souls.get(soul) || new Set<TGSocket>();
+            this._souls.set(soul, sockets.add(socket));
+        }
+
+        return this;
+    }
+
+    /**
+     * Release the soul reference of a get request
+     */
+    unsubscribe(socket: TGSocket, msgId: string): TGMuxHub
+    {
+        const state = this._sockets.get(socket);
+        const soul  = state && state.requests.get(msgId);
+
+        if (!soul)
+        {
+            return this;
+        }
+
+        const count = (state.souls.get(soul) as number) - 1;
+
+        state.requests.delete(msgId);
+
+        if (count > 0)
+        {
+            state.souls.set(soul, count);
+        }
+        else
+        {
+            state.souls.delete(soul);
+            this._removeSoulSocket(soul, socket);
+        }
+
+        return this;
+    }
+
+    /**
+     * Forget a closed socket with all its references
+     */
+    removeSocket(socket: TGSocket): TGMuxHub
+    {
+        const state = this._state(socket);
+
+        state.souls.forEach((_count, soul) => this._removeSoulSocket(soul, socket));
+        state.requests.clear();
+        state.souls.clear();
+        state.pending = [];
+        state.closed  = true;
+
+        return this;
+    }
+
+    /**
+     * Send a graph diff to every socket holding a reference on its souls, one message per socket
+     */
+    publish(diff: TGGraphData, msgId: string): TGMuxHub
+    {
+        const puts = new Map<TGSocket, TGGraphData>();
+
+        for (const soul in diff)
+        {
+            const sockets = soul && diff[soul] && this._souls.get(soul);
+
+            if (!sockets)
+            {
+                continue;
+            }
+
+            sockets.forEach((socket) =>
+            {
+                const put = puts.get(socket) || {};
+                put[soul] = diff[soul];
+                puts.set(socket, put);
+            });
+        }
+
+        puts.forEach((put, socket) =>
+        {
+            this.send(socket, { '#': `${msgId}/${socket.id}`, put });
+        });
+
+        return this;
+    }
+
+    /**
+     * Queue a message for the next frame of the socket
+     */
+    send(socket: TGSocket, msg: TGMessage): TGMuxHub
+    {
+        const state = this._state(socket);
+
+        if (state.closed)
+        {
+            return this;
+        }
+        if (!state.pending.length)
+        {
+            Promise.resolve().then(() => this._flush(socket, state));
+        }
+        state.pending.push(msg);
+
+        return this;
+    }
+
+    /**
+     * Number of sockets holding a reference on the soul
+     */
+    subscriberCount(soul: string): number
+    {
+        const sockets = this._souls.get(soul);
+        return sockets ? sockets.size : 0;
+    }
+
+    /**
+     * Invoke callback with the number of subscribed sockets of every soul
+     */
+    forEachSoul(cb: (soul: string, subscribers: number) => void): void
+    {
+        this._souls.forEach((sockets, soul) => cb(soul, sockets.size));
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    private _state(socket: TGSocket): TGMuxSocketState
+    {
+        let state = this._sockets.get(socket);
+
+        if (!state)
+        {
+            state = { requests: new Map(), souls: new Map(), pending: [], closed: false };
+            this._sockets.set(socket, state);
+        }
+
+        return state;
+    }
+
+    private _flush(socket: TGSocket, state: TGMuxSocketState): void
+    {
+        const frame: TGMuxFrame = { msgs: state.pending };
+        state.pending           = [];
+
+        if (frame.msgs.length)
+        {
+            socket.transmit(TG_MUX_EVENT, frame);
+        }
+    }
+
+    private _removeSoulSocket(soul: string, socket: TGSocket): void
+    {
+        const sockets = this._souls.get(soul);
+
+        if (sockets && sockets.delete(socket) && !sockets.size)
+        {
+            this._souls.delete(soul);
+        }
+    }
+}
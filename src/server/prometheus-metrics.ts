@@ -0,0 +1,183 @@
+import { TGMetricLabels, TGMetrics } from '../types';
+
+export const DEFAULT_HISTOGRAM_BUCKETS = [0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5];
+
+type TGMetricType = 'counter'|'gauge'|'histogram';
+
+interface TGMetricSeries
+{
+    readonly labels: string;
+    value: number;
+    /** Histogram observations per bucket, not cumulative */
+    readonly buckets?: number[];
+    count?: number;
+}
+
+interface TGMetricFamily
+{
+    readonly type: TGMetricType;
+    readonly series: Map<string, TGMetricSeries>;
+}
+
+/**
+ * Metrics kept in memory and rendered in the Prometheus text format, serve `render()` on a scrape endpoint
+ */
+export class TGPrometheusMetrics implements TGMetrics
+{
+    private readonly _families: Map<string, TGMetricFamily>;
+    private readonly _collectors: (() => void)[];
+
+    /**
+     * Constructor
+     */
+    constructor(readonly buckets: number[] = DEFAULT_HISTOGRAM_BUCKETS)
+    {
+        this._families   = new Map();
+        this._collectors = [];
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    observe(name: string, value: number, labels?: TGMetricLabels): void
+    {
+        const series = this._series(name, 'histogram', labels);
+        const index  = this.buckets.findIndex(bound => value <= bound);
+
+        if (index !== -1)
+        {
+            series.buckets[index]++;
+        }
+        series.value += value;
+        series.count++;
+    }
+
+    increment(name: string, value = 1, labels?: TGMetricLabels): void
+    {
+        this._series(name, 'counter', labels).value += value;
+    }
+
+    gauge(name: string, value: number, labels?: TGMetricLabels): void
+    {
+        this._series(name, 'gauge', labels).value = value;
+    }
+
+    remove(name: string, labels?: TGMetricLabels): void
+    {
+        const family = this._families.get(name);
+
+        if (family)
+        {
+            family.series.delete(formatLabels(labels));
+        }
+    }
+
+    addCollector(collect: () => void): void
+    {
+        this._collectors.push(collect);
+    }
+
+    /**
+     * Current metrics in the Prometheus text exposition format
+     */
+    render(): string
+    {
+        this._collectors.forEach(collect => collect());
+
+        const lines: string[] = [];
+
+        this._families.forEach((family, name) =>
+        {
+            lines.push(`# TYPE ${name} ${family.type}`);
+
+            family.series.forEach((series) =>
+            {
+                if (family.type !== 'histogram')
+                {
+                    lines.push(`${name}${wrapLabels(series.labels)} ${series.value}`);
+                    return;
+                }
+
+                let cumulative = 0;
+
+                this.buckets.forEach((bound, i) =>
+                {
+                    cumulative += series.buckets[i];
+                    lines.push(`${name}_bucket${wrapLabels(joinLabels(series.labels, `le="${bound}"`))} ${cumulative}`);
+                });
+                lines.push(`${name}_bucket${wrapLabels(joinLabels(series.labels, 'le="+Inf"'))} ${series.count}`);
+                lines.push(`${name}_sum${wrapLabels(series.labels)} ${series.value}`);
+                lines.push(`${name}_count${wrapLabels(series.labels)} ${series.count}`);
+            });
+        });
+
+        return lines.join('\n') + '\n';
+    }
+
+    /**
+     * Drop all series, collectors stay registered
+     */
+    reset(): void
+    {
+        this._families.clear();
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    private _series(name: string, type: TGMetricType, labels?: TGMetricLabels): TGMetricSeries
+    {
+        let family = this._families.get(name);
+
+        if (!family)
+        {
+            family = { type, series: new Map() };
+            this._families.set(name, family);
+        }
+        else if (family.type !== type)
+        {
+            throw new TypeError(`Metric ${name} is a ${family.type}, not a ${type}.`);
+        }
+
+        const key  = formatLabels(labels);
+        let series = family.series.get(key);
+
+        if (!series)
+        {
+            series = type === 'histogram'
+                ? { labels: key, value: 0, buckets: this.buckets.map(() => 0), count: 0 }
+                : { labels: key, value: 0 };
+            family.series.set(key, series);
+        }
+
+        return series;
+    }
+}
+
+/**
+ * Labels sorted by name, values escaped as the text format requires
+ */
+function formatLabels(labels: TGMetricLabels|undefined): string
+{
+    if (!labels)
+    {
+        return '';
+    }
+
+    return Object.keys(labels)
+        .sort()
+        .map(name => `${name}="${String(labels[name]).replace(/\\/g, '\\\\').replace(/\n/g, '\\n').replace(/"/g, '\\"')}"`)
+        .join(',');
+}
+
+function joinLabels(labels: string, label: string): string
+{
+    return labels ? `${labels},${label}` : label;
+}
+
+function wrapLabels(labels: string): string
+{
+    return labels ? `{${labels}}` : '';
+}
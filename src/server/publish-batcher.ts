@@ -0,0 +1,198 @@
+import { isNumber } from 'topgun-typed';
+import { TGSocket } from 'topgun-socket/server';
+import { TGGraphData } from '../types';
+import { mergeNodes } from '../crdt';
+import { pseudoRandomText } from '../sea';
+
+/**
+ * Coalesces node diffs per subscriber socket, so a put touching many souls
+ * reaches every subscriber as a single multi-soul put frame.
+ *
+ * The frame is sent on the channel of one of the socket's subscribed souls,
+ * clients ingest every soul of a received put. Souls the socket left before the flush are dropped
+ * from its frame. The server removes subscribers when they unsubscribe or close.
+ */
+export class TGPublishBatcher
+{
+    private readonly _subscribers: Map<string, Set<TGSocket>>;
+    /** Subscribed souls per socket, so a closed socket is removed from all of them */
+    private readonly _souls: Map<TGSocket, Set<string>>;
+    private readonly _pending: Map<TGSocket, TGGraphData>;
+    private _scheduled: boolean;
+
+    /**
+     * Constructor
+     */
+    constructor(private readonly window: number)
+    {
+        this._subscribers = new Map();
+        this._souls       = new Map();
+        this._pending     = new Map();
+        this._scheduled   = false;
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Register a socket subscribing to a soul channel
+     */
+    addSubscriber(soul: string, socket: TGSocket): TGPublishBatcher
+    {
+        const sockets = this._subscribers.get(soul) || new Set<TGSocket>();
+        const souls   = this._souls.get(socket) || new Set<string>();
+
+        this._subscribers.set(soul, sockets.add(socket));
+        this._souls.set(socket, souls.add(soul));
+        return this;
+    }
+
+    /**
+     * Forget a socket leaving a soul channel
+     */
+    removeSubscriber(soul: string, socket: TGSocket): TGPublishBatcher
+    {
+        const sockets = this._subscribers.get(soul);
+        const souls   = this._souls.get(socket);
+
+        if (sockets && sockets.delete(socket) && !sockets.size)
+        {
+            this._subscribers.delete(soul);
+        }
+        if (souls && souls.delete(soul) && !souls.size)
+        {
+            this._souls.delete(socket);
+        }
+
+        return this;
+    }
+
+    /**
+     * Forget a closed socket, its queued diffs are not sent
+     */
+    removeSocket(socket: TGSocket): TGPublishBatcher
+    {
+        const souls = this._souls.get(socket);
+
+        if (souls)
+        {
+            souls.forEach(soul => this.removeSubscriber(soul, socket));
+        }
+        this._pending.delete(socket);
+
+        return this;
+    }
+
+    /**
+     * Queue a graph diff for every socket subscribed to its souls
+     */
+    publish(diff: TGGraphData): TGPublishBatcher
+    {
+        for (const soul in diff)
+        {
+            const nodeDiff = soul && diff[soul];
+            const sockets  = nodeDiff && this._subscribers.get(soul);
+
+            if (!sockets)
+            {
+                continue;
+            }
+
+            const channel = channelForSoul(soul);
+
+            sockets.forEach((socket) =>
+            {
+                // Subscriptions are dropped lazily, once the socket left the channel
+                if (!socket.isSubscribed(channel, true))
+                {
+                    this.removeSubscriber(soul, socket);
+                    return;
+                }
+
+                const pending = this._pending.get(socket) || {};
+                pending[soul] = mergeNodes(pending[soul], nodeDiff);
+                this._pending.set(socket, pending);
+            });
+
+        }
+
+        if (this._pending.size)
+        {
+            this._schedule();
+        }
+
+        return this;
+    }
+
+    /**
+     * Send all queued diffs, one frame per socket
+     */
+    flush(): void
+    {
+        this._scheduled = false;
+
+        const msgId = pseudoRandomText();
+
+        this._pending.forEach((pending, socket) =>
+        {
+            const put: TGGraphData = {};
+            let channel: string|undefined;
+
+            // Sockets may leave channels between publish and flush
+            for (const soul in pending)
+            {
+                const soulChannel = channelForSoul(soul);
+
+                if (socket.isSubscribed(soulChannel, true))
+                {
+                    put[soul] = pending[soul];
+                    channel   = channel || soulChannel;
+                }
+                else
+                {
+                    this.removeSubscriber(soul, socket);
+                }
+            }
+
+            if (channel)
+            {
+                socket.transmit('#publish', {
+                    channel,
+                    data: {
+                        '#': `${msgId}/${socket.id}`,
+                        put,
+                    },
+                });
+            }
+        });
+        this._pending.clear();
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    private _schedule(): void
+    {
+        if (this._scheduled)
+        {
+            return;
+        }
+        this._scheduled = true;
+
+        if (isNumber(this.window) && this.window > 0)
+        {
+            setTimeout(() => this.flush(), this.window);
+        }
+        else
+        {
+            Promise.resolve().then(() => this.flush());
+        }
+    }
+}
+
+function channelForSoul(soul: string): string
+{
+    return `topgun/nodes/${soul}`;
+}
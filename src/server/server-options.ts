@@ -1,11 +1,45 @@
 import { TGSocketServerOptions } from 'topgun-socket/server';
-import { TGGraphAdapter, TGGraphAdapterOptions } from '../types';
+import { TGGraphAdapter, TGGraphAdapterOptions, TGMetrics } from '../types';
+import { TGSeaValidatorOptions } from '../validator-sea';
+import { TGBroker } from './broker';
+import { TGWriteSchedulerOptions } from './write-scheduler';
 
 export interface TGServerOptions extends TGSocketServerOptions, TGGraphAdapterOptions
 {
     disableValidation?: boolean;
+    /**
+     * Reject writes to user souls (~pub) with fields not signed by that pub.
+     * Writes signed through a certificate carry another user's signature and are rejected as well
+     */
+    verifySignatures?: boolean|TGSeaValidatorOptions;
     authMaxDrift?: number;
     ownerPub?: string;
     adapter?: TGGraphAdapter;
     port?: number;
+    /**
+     * Coalesce node diffs per subscriber socket for this many ms into one multi-soul put frame,
+     * 0 batches within the current tick. Unset publishes every soul separately.
+     * Frame compression is configured with the socket server options
+     */
+    publishBatchWindow?: number;
+    /**
+     * Share stored diffs with the other servers of a cluster, so any server can serve any subscriber.
+     * Diffs from other servers are written to this server's adapter and published to its subscribers
+     */
+    broker?: TGBroker;
+    /**
+     * Answer gets in pages of this many souls, streamed as separate replies.
+     * Every page but the last carries a `$` cursor a get can resume from. Unset answers with one reply
+     */
+    listPageSize?: number;
+    /**
+     * Queue socket puts per socket and write them round-robin, puts of one socket to the same souls
+     * are merged, puts touching a soul being written wait for it. Unset writes every put at once
+     */
+    writeScheduler?: boolean|TGWriteSchedulerOptions;
+    /**
+     * Sink for put and get stage timings, soul subscriptions and socket bytes,
+     * also handed to the default adapter for storage timings
+     */
+    metrics?: TGMetrics;
 }
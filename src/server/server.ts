@@ -1,12 +1,30 @@
-import { Struct, Result, ok, isErr, isObject, isFunction } from 'topgun-typed';
+import { Struct, Result, ok, isErr, isObject, isFunction, isNumber } from 'topgun-typed';
 import { pseudoRandomText, verify } from '../sea';
-import { TGGraphAdapter, TGGraphData, TGMessage } from '../types';
+import {
+    TG_METRIC_PUT_SECONDS,
+    TG_METRIC_SOCKET_BYTES,
+    TG_METRIC_SOUL_SUBSCRIPTIONS,
+    TG_MUX_EVENT,
+    TGGraphAdapter,
+    TGGraphData,
+    TGMessage,
+    TGMetricLabels,
+    TGMetrics,
+    TGMuxFrame,
+} from '../types';
 import { TGServerOptions } from './server-options';
 import { listen, TGSocketServer, TGSocket } from 'topgun-socket/server';
 import { createMemoryAdapter } from '../memory-adapter';
-import { createValidator } from '../validator';
+import { createFastValidator } from '../validator';
+import { createSeaValidator, TGSeaValidator } from '../validator-sea';
 import { Middleware } from './middleware';
+import { TGPublishBatcher } from './publish-batcher';
+import { TGMuxHub } from './mux-hub';
+import { TGWriteScheduler } from './write-scheduler';
+import { TGBrokerLink } from './broker';
 import { uuidv4 } from '../utils/uuidv4';
+import { metricsNow, observeSince } from '../utils/metrics';
+import { utf8ByteLength } from '../storage/utils';
 
 export class TGServer
 {
@@ -16,7 +34,15 @@ export class TGServer
     readonly options: TGServerOptions;
     readonly middleware: Middleware;
 
+    protected readonly publishBatcher: TGPublishBatcher|undefined;
+    protected readonly muxHub: TGMuxHub;
+    protected readonly writeScheduler: TGWriteScheduler|undefined;
+    protected readonly brokerLink: TGBrokerLink|undefined;
     protected readonly validator: Struct<TGGraphData>;
+    protected readonly seaValidator: TGSeaValidator|undefined;
+    protected readonly metrics: TGMetrics|undefined;
+    /** Channel subscriptions per soul, counted while metrics are enabled */
+    private readonly subscriptions: Map<string, number>;
 
     /**
      * Constructor
@@ -24,11 +50,36 @@ export class TGServer
     constructor(options?: TGServerOptions)
     {
         this.options         = isObject(options) ? options : {};
-        this.validator       = createValidator();
+        this.metrics         = this.options.metrics;
+        this.subscriptions   = new Map();
+        this.validator       = createFastValidator();
+        this.seaValidator    = this.options.verifySignatures
+            ? createSeaValidator(isObject(this.options.verifySignatures) ? this.options.verifySignatures : {})
+            : undefined;
         this.internalAdapter = this.options.adapter || createMemoryAdapter(options);
         this.adapter         = this.wrapAdapter(this.internalAdapter);
+        this.brokerLink      = this.options.broker
+            ? new TGBrokerLink(this.options.broker, this.internalAdapter, msg => this.publishIsDiff(msg))
+            : undefined;
+        this.publishBatcher  = isNumber(this.options.publishBatchWindow)
+            ? new TGPublishBatcher(this.options.publishBatchWindow)
+            : undefined;
+        this.muxHub          = new TGMuxHub();
+        this.writeScheduler  = this.options.writeScheduler
+            ? new TGWriteScheduler(
+                graph => this.adapter.put(graph),
+                isObject(this.options.writeScheduler) ? this.options.writeScheduler : {},
+            )
+            : undefined;
         this.gateway         = listen(this.options.port, this.options);
-        this.middleware      = new Middleware(this.gateway, this.options, this.adapter);
+        this.middleware      = new Middleware(
+            this.gateway,
+            this.options,
+            this.adapter,
+            this.publishBatcher,
+            this.muxHub,
+            this.writeScheduler,
+        );
         this.run();
     }
 
@@ -48,6 +99,15 @@ export class TGServer
             this.gateway.httpServer.close();
         }
         await this.gateway.close();
+
+        if (this.seaValidator)
+        {
+            await this.seaValidator.close();
+        }
+        if (this.brokerLink)
+        {
+            this.brokerLink.close();
+        }
     }
 
     // -----------------------------------------------------------------------------------------------------
@@ -61,6 +121,16 @@ export class TGServer
     {
         this.middleware.setupMiddleware();
         this.handleWebsocketConnection();
+
+        if (this.publishBatcher)
+        {
+            this.removeBatchedSubscribers(this.publishBatcher);
+        }
+
+        if (this.metrics)
+        {
+            this.setupMetrics(this.metrics);
+        }
     }
 
     /**
@@ -89,14 +159,26 @@ export class TGServer
             ...adapter,
             put: async (graph: TGGraphData) =>
             {
+                let start  = metricsNow(this.metrics);
                 const diff = await adapter.put(graph);
+                observeSince(this.metrics, TG_METRIC_PUT_SECONDS, start, { stage: 'storage' });
 
                 if (diff)
                 {
-                    this.publishIsDiff({
+                    start = metricsNow(this.metrics);
+
+                    const msg: TGMessage = {
                         '#'  : pseudoRandomText(),
                         'put': diff,
-                    });
+                    };
+
+                    this.publishIsDiff(msg);
+
+                    if (this.brokerLink)
+                    {
+                        this.brokerLink.share(msg);
+                    }
+                    observeSince(this.metrics, TG_METRIC_PUT_SECONDS, start, { stage: 'publish' });
                 }
 
                 return diff;
@@ -107,13 +189,27 @@ export class TGServer
             ...withPublish,
             put: async (graph: TGGraphData) =>
             {
+                let start    = metricsNow(this.metrics);
                 const result = this.validatePut(graph);
+                observeSince(this.metrics, TG_METRIC_PUT_SECONDS, start, { stage: 'validate' });
 
                 if (isErr(result))
                 {
                     throw result.error;
                 }
 
+                if (this.seaValidator)
+                {
+                    start           = metricsNow(this.metrics);
+                    const seaResult = await this.seaValidator.validate(graph);
+                    observeSince(this.metrics, TG_METRIC_PUT_SECONDS, start, { stage: 'verify' });
+
+                    if (isErr(seaResult))
+                    {
+                        throw seaResult.error;
+                    }
+                }
+
                 return withPublish.put(graph);
             },
         };
@@ -132,6 +228,14 @@ export class TGServer
             return;
         }
 
+        this.muxHub.publish(diff, msgId);
+
+        if (this.publishBatcher)
+        {
+            this.publishBatcher.publish(diff);
+            return;
+        }
+
         for (const soul in diff)
         {
             if (!soul)
@@ -162,10 +266,139 @@ export class TGServer
         return this.validator(graph);
     }
 
+    /**
+     * Count soul subscriptions and report them when metrics are read
+     */
+    protected setupMetrics(metrics: TGMetrics): void
+    {
+        (async () =>
+        {
+            for await (const { channel } of this.gateway.listener('subscription'))
+            {
+                this.countSubscription(channel, 1);
+            }
+        })();
+
+        (async () =>
+        {
+            for await (const { channel } of this.gateway.listener('unsubscription'))
+            {
+                this.countSubscription(channel, -1);
+            }
+        })();
+
+        if (!metrics.addCollector)
+        {
+            return;
+        }
+
+        let reported = new Map<string, TGMetricLabels>();
+
+        metrics.addCollector(() =>
+        {
+            const current = new Map<string, TGMetricLabels>();
+            const report  = (soul: string, transport: string, subscribers: number) =>
+            {
+                const labels = { soul, transport };
+
+                current.set(`${transport}/${soul}`, labels);
+                metrics.gauge(TG_METRIC_SOUL_SUBSCRIPTIONS, subscribers, labels);
+            };
+
+            this.subscriptions.forEach((count, soul) => report(soul, 'channel', count));
+            this.muxHub.forEachSoul((soul, count) => report(soul, 'mux', count));
+
+            // Souls nobody listens to anymore leave the report
+            reported.forEach((labels, key) =>
+            {
+                if (!current.has(key) && metrics.remove)
+                {
+                    metrics.remove(TG_METRIC_SOUL_SUBSCRIPTIONS, labels);
+                }
+            });
+            reported = current;
+        });
+    }
+
+    /**
+     * Count bytes a socket sends and receives.
+     * The server has no outbound hook, so outgoing bytes are counted by wrapping `send` on the socket.
+     * This relies on `send` being the only outgoing path: transmit, invoke, publish and the mux frames
+     * of `TGMuxHub` end in it, anything written to the transport directly is not counted
+     */
+    protected measureSocket(socket: TGSocket, metrics: TGMetrics): void
+    {
+        const labelsIn  = { socket: socket.id, direction: 'in' };
+        const labelsOut = { socket: socket.id, direction: 'out' };
+        const send      = socket.send.bind(socket);
+
+        socket.send = (data: any, options?: any) =>
+        {
+            metrics.increment(TG_METRIC_SOCKET_BYTES, byteLength(data), labelsOut);
+            return send(data, options);
+        };
+
+        (async () =>
+        {
+            for await (const { message } of socket.listener('message'))
+            {
+                metrics.increment(TG_METRIC_SOCKET_BYTES, byteLength(message), labelsIn);
+            }
+        })();
+
+        (async () =>
+        {
+            await socket.listener('close').once();
+
+            if (metrics.remove)
+            {
+                metrics.remove(TG_METRIC_SOCKET_BYTES, labelsIn);
+                metrics.remove(TG_METRIC_SOCKET_BYTES, labelsOut);
+            }
+        })();
+    }
+
     // -----------------------------------------------------------------------------------------------------
     // @ Private methods
     // -----------------------------------------------------------------------------------------------------
 
+    private countSubscription(channel: string, change: number): void
+    {
+        const soul = channel && channel.replace(/^topgun\/nodes\//, '');
+
+        if (!soul || soul === channel)
+        {
+            return;
+        }
+
+        const count = (this.subscriptions.get(soul) || 0) + change;
+
+        if (count > 0)
+        {
+            this.subscriptions.set(soul, count);
+        }
+        else
+        {
+            this.subscriptions.delete(soul);
+        }
+    }
+
+    /**
+     * Drop batched subscribers leaving a soul channel
+     */
+    private async removeBatchedSubscribers(publishBatcher: TGPublishBatcher): Promise<void>
+    {
+        for await (const { socket, channel } of this.gateway.listener('unsubscription'))
+        {
+            const soul = String(channel).replace(/^topgun\/nodes\//, '');
+
+            if (soul !== channel)
+            {
+                publishBatcher.removeSubscriber(soul, socket as TGSocket);
+            }
+        }
+    }
+
     /**
      * Set up a loop to handle websocket connections.
      */
@@ -173,6 +406,11 @@ export class TGServer
     {
         for await (const { socket } of this.gateway.listener('connection'))
         {
+            if (this.metrics)
+            {
+                this.measureSocket(socket as TGSocket, this.metrics);
+            }
+
             (async () =>
             {
                 // Set up a loop to handle and respond to RPCs.
@@ -181,6 +419,25 @@ export class TGServer
                     this.authenticateLogin(socket, request);
                 }
             })();
+
+            (async () =>
+            {
+                for await (const frame of (socket as TGSocket).receiver(TG_MUX_EVENT))
+                {
+                    this.middleware.processMuxFrame(socket, frame as TGMuxFrame);
+                }
+            })();
+
+            (async () =>
+            {
+                await (socket as TGSocket).listener('close').once();
+                this.muxHub.removeSocket(socket);
+
+                if (this.publishBatcher)
+                {
+                    this.publishBatcher.removeSocket(socket);
+                }
+            })();
         }
     }
 
@@ -255,3 +512,12 @@ export class TGServer
     }
 }
 
+function byteLength(data: unknown): number
+{
+    if (typeof data === 'string')
+    {
+        return utf8ByteLength(data);
+    }
+
+    return data && isNumber((data as ArrayBufferLike).byteLength) ? (data as ArrayBufferLike).byteLength : 0;
+}
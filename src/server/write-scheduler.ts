@@ -0,0 +1,215 @@
+import { isNumber } from 'topgun-typed';
+import { TGGraphData } from '../types';
+import { mergeGraphInPlace } from '../crdt';
+
+export interface TGWriteSchedulerOptions
+{
+    /** Writes running at once, 8 by default */
+    concurrency?: number;
+    /** Most queued puts of one source merged into a single write, 64 by default */
+    maxBatchSize?: number;
+}
+
+interface TGWriteJob
+{
+    readonly graph: TGGraphData;
+    readonly souls: string[];
+    readonly resolve: () => void;
+    readonly reject: (error: unknown) => void;
+}
+
+const DEFAULT_CONCURRENCY    = 8;
+const DEFAULT_MAX_BATCH_SIZE = 64;
+
+/**
+ * Schedules puts of many sources, usually sockets, onto the adapter.
+ *
+ * Every source has its own queue and the queues are served round-robin, so a bulk import
+ * does not hold back interactive writers. Writes touching the same soul never run at once,
+ * the adapter merge is not retried against a concurrent write. When a source is served,
+ * its leading runnable puts are merged into one write. If that write fails,
+ * the merged puts are written one by one, so every put gets its own result
+ */
+export class TGWriteScheduler
+{
+    readonly concurrency: number;
+    readonly maxBatchSize: number;
+
+    /** Queues of the sources with pending puts, in the order they are served */
+    private readonly _queues: Map<string, TGWriteJob[]>;
+    private readonly _locked: Set<string>;
+    private _running: number;
+    private _draining: boolean;
+
+    /**
+     * Constructor
+     */
+    constructor(
+        private readonly write: (graph: TGGraphData) => Promise<unknown>,
+        options?: TGWriteSchedulerOptions,
+    )
+    {
+        this.concurrency  = isNumber(options?.concurrency) && options.concurrency > 0
+            ? options.concurrency
+            : DEFAULT_CONCURRENCY;
+        this.maxBatchSize = isNumber(options?.maxBatchSize) && options.maxBatchSize > 0
+            ? options.maxBatchSize
+            : DEFAULT_MAX_BATCH_SIZE;
+        this._queues      = new Map();
+        this._locked      = new Set();
+        this._running     = 0;
+        this._draining    = false;
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Accessors
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Puts waiting to be written
+     */
+    get pending(): number
+    {
+        let count = 0;
+        this._queues.forEach(queue => count += queue.length);
+        return count;
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Queue a put of a source, resolves once it is written
+     */
+    schedule(source: string, graph: TGGraphData): Promise<void>
+    {
+        return new Promise<void>((resolve, reject) =>
+        {
+            const queue = this._queues.get(source) || [];
+
+            queue.push({ graph, souls: Object.keys(graph).filter(soul => !!soul), resolve, reject });
+            this._queues.set(source, queue);
+
+            // Puts of the current tick are queued before any is taken, so they can be merged
+            if (!this._draining)
+            {
+                this._draining = true;
+                Promise.resolve().then(() =>
+                {
+                    this._draining = false;
+                    this._drain();
+                });
+            }
+        });
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    private _drain(): void
+    {
+        while (this._running < this.concurrency)
+        {
+            const batch = this._next();
+
+            if (!batch)
+            {
+                return;
+            }
+            this._run(batch);
+        }
+    }
+
+    /**
+     * Take the leading runnable puts of the first source that has any, the source moves to the back
+     */
+    private _next(): TGWriteJob[]|null
+    {
+        for (const [source, queue] of this._queues)
+        {
+            if (!this._isRunnable(queue[0]))
+            {
+                continue;
+            }
+
+            let count = 1;
+
+            while (count < queue.length && count < this.maxBatchSize && this._isRunnable(queue[count]))
+            {
+                count++;
+            }
+
+            const batch = queue.splice(0, count);
+
+            this._queues.delete(source);
+            if (queue.length)
+            {
+                this._queues.set(source, queue);
+            }
+
+            return batch;
+        }
+
+        return null;
+    }
+
+    private _isRunnable(job: TGWriteJob): boolean
+    {
+        return job.souls.every(soul => !this._locked.has(soul));
+    }
+
+    private async _run(batch: TGWriteJob[]): Promise<void>
+    {
+        const souls = new Set<string>();
+
+        batch.forEach(job => job.souls.forEach(soul => souls.add(soul)));
+        souls.forEach(soul => this._locked.add(soul));
+        this._running++;
+
+        try
+        {
+            if (batch.length === 1)
+            {
+                await this._writeJob(batch[0]);
+                return;
+            }
+
+            const merged: TGGraphData = {};
+            batch.forEach(job => mergeGraphInPlace(merged, job.graph));
+
+            try
+            {
+                await this.write(merged);
+                batch.forEach(job => job.resolve());
+            }
+            catch (e)
+            {
+                for (const job of batch)
+                {
+                    await this._writeJob(job);
+                }
+            }
+        }
+        finally
+        {
+            souls.forEach(soul => this._locked.delete(soul));
+            this._running--;
+            this._drain();
+        }
+    }
+
+    private async _writeJob(job: TGWriteJob): Promise<void>
+    {
+        try
+        {
+            await this.write(job.graph);
+            job.resolve();
+        }
+        catch (e)
+        {
+            job.reject(e);
+        }
+    }
+}
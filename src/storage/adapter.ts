@@ -1,16 +1,26 @@
-import { isNumber, isString } from 'topgun-typed';
+import { isFunction, isNumber, isString } from 'topgun-typed';
 import { StorageListOptions, TGStorage } from './types';
-import { TGGraphAdapter, TGGraphAdapterOptions, TGGraphData, TGOptionsGet } from '../types';
-import { diffCRDT, mergeGraph } from '../crdt';
+import { TG_METRIC_STORAGE_SECONDS, TGGraphAdapter, TGGraphAdapterOptions, TGGraphData, TGOptionsGet } from '../types';
+import { diffFromChanges, mergeGraphInPlace } from '../crdt';
 import { assertPutEntry, storageListOptionsFromGetOptions } from './utils';
-
-const DEFAULT_CRDT_OPTS = {
-    diffFn : diffCRDT,
-    mergeFn: mergeGraph,
-};
+import { CachedStorage } from './cached-storage';
+import { metricsNow, observeSince } from '../utils/metrics';
 
 export function createGraphAdapter(storage: TGStorage, adapterOptions?: TGGraphAdapterOptions): TGGraphAdapter
 {
+    const cacheSize = adapterOptions && adapterOptions.readCacheSize;
+
+    if (isNumber(cacheSize) && cacheSize > 0)
+    {
+        const cached = new CachedStorage(storage, cacheSize);
+
+        return {
+            get       : (opts: TGOptionsGet) => get(cached, opts),
+            put       : (graphData: TGGraphData) => put(cached, graphData, adapterOptions),
+            cacheStats: () => cached.stats(),
+        };
+    }
+
     return {
         get: (opts: TGOptionsGet) => get(storage, opts),
         put: (graphData: TGGraphData) => put(storage, graphData, adapterOptions),
@@ -62,9 +72,13 @@ async function put(
     db: TGStorage,
     data: TGGraphData,
     adapterOptions?: TGGraphAdapterOptions,
-    crdtOptions = DEFAULT_CRDT_OPTS,
 ): Promise<TGGraphData|null>
 {
+    if (isFunction(db.getMany) && isFunction(db.putMany))
+    {
+        return await patchGraphBatch(db, data, adapterOptions);
+    }
+
     const diff: TGGraphData = {};
 
     for (const soul in data)
@@ -80,7 +94,6 @@ async function put(
                 [soul]: data[soul],
             },
             adapterOptions,
-            crdtOptions,
         );
 
         if (nodeDiff)
@@ -92,16 +105,65 @@ async function put(
     return Object.keys(diff).length ? diff : null;
 }
 
+/**
+ * Merge the whole graph in place against one batch read, then commit it with one batch write
+ */
+async function patchGraphBatch(
+    db: TGStorage,
+    data: TGGraphData,
+    adapterOptions?: TGGraphAdapterOptions,
+): Promise<TGGraphData|null>
+{
+    const souls = Object.keys(data).filter(soul => !!soul);
+
+    if (!souls.length)
+    {
+        return null;
+    }
+
+    const metrics  = adapterOptions && adapterOptions.metrics;
+    let start      = metricsNow(metrics);
+    const existing = await db.getMany(souls);
+    observeSince(metrics, TG_METRIC_STORAGE_SECONDS, start, { op: 'read' });
+
+    start         = metricsNow(metrics);
+    const changes = mergeGraphInPlace(existing, data);
+    observeSince(metrics, TG_METRIC_STORAGE_SECONDS, start, { op: 'merge' });
+
+    if (!changes)
+    {
+        return null;
+    }
+
+    const toWrite: TGGraphData = {};
+
+    for (const soul in changes)
+    {
+        toWrite[soul] = existing[soul];
+    }
+
+    const diff = diffFromChanges(existing, changes);
+
+    start = metricsNow(metrics);
+    await writeRawGraph(db, toWrite, adapterOptions, diff);
+    observeSince(metrics, TG_METRIC_STORAGE_SECONDS, start, { op: 'write' });
+
+    return diff;
+}
+
 async function patchGraphFull(
     db: TGStorage,
     data: TGGraphData,
     adapterOptions?: TGGraphAdapterOptions,
-    crdtOptions = DEFAULT_CRDT_OPTS,
 ): Promise<TGGraphData|null>
 {
+    const metrics = adapterOptions && adapterOptions.metrics;
+
     while (true)
     {
-        const patchDiffData = await getPatchDiff(db, data, crdtOptions);
+        let start           = metricsNow(metrics);
+        const patchDiffData = await getPatchDiff(db, data);
+        observeSince(metrics, TG_METRIC_STORAGE_SECONDS, start, { op: 'read' });
 
         if (!patchDiffData)
         {
@@ -109,7 +171,11 @@ async function patchGraphFull(
         }
         const { diff, toWrite } = patchDiffData;
 
-        if (await writeRawGraph(db, toWrite, adapterOptions))
+        start         = metricsNow(metrics);
+        const written = await writeRawGraph(db, toWrite, adapterOptions, diff);
+        observeSince(metrics, TG_METRIC_STORAGE_SECONDS, start, { op: 'write' });
+
+        if (written)
         {
             return diff;
         }
@@ -121,40 +187,29 @@ async function patchGraphFull(
 async function getPatchDiff(
     db: TGStorage,
     data: TGGraphData,
-    crdtOptions = DEFAULT_CRDT_OPTS,
 ): Promise<null|{
         readonly diff: TGGraphData;
-        readonly existing: TGGraphData;
         readonly toWrite: TGGraphData;
     }>
 {
-    const { diffFn = diffCRDT, mergeFn = mergeGraph } = crdtOptions;
-    const existing                                    = await getExisting(db, data);
-    const graphDiff                                   = diffFn(data, existing);
+    const existing = await getExisting(db, data);
+    const changes  = mergeGraphInPlace(existing, data);
 
-    if (!graphDiff || !Object.keys(graphDiff).length)
+    if (!changes)
     {
         return null;
     }
 
-    const existingFromDiff: TGGraphData = {};
+    const toWrite: TGGraphData = {};
 
-    for (const soul in graphDiff)
+    for (const soul in changes)
     {
-        if (!soul)
-        {
-            continue;
-        }
-
-        existingFromDiff[soul] = existing[soul];
+        toWrite[soul] = existing[soul];
     }
 
-    const updatedGraph = mergeFn(existing, graphDiff, 'mutable');
-
     return {
-        diff    : graphDiff,
-        existing: existingFromDiff,
-        toWrite : updatedGraph as TGGraphData,
+        diff: diffFromChanges(existing, changes),
+        toWrite,
     };
 }
 
@@ -181,34 +236,46 @@ async function getExisting(
 async function writeRawGraph(
     db: TGStorage,
     data: TGGraphData,
-    adapterOptions?: TGGraphAdapterOptions
+    adapterOptions?: TGGraphAdapterOptions,
+    diff?: TGGraphData,
 ): Promise<boolean>
 {
-    try
+    const nodes: TGGraphData = {};
+
+    for (const soul in data)
     {
-        for (const soul in data)
+        if (!soul)
         {
-            if (!soul)
-            {
-                continue;
-            }
-
-            const nodeToWrite = data[soul];
+            continue;
+        }
 
-            if (!nodeToWrite)
-            {
-                // TODO db.removeItem(soul)?
-                continue;
-            }
+        const nodeToWrite = data[soul];
 
-            assertPutEntry(soul, nodeToWrite, adapterOptions);
-            await db.put(soul, nodeToWrite);
+        if (!nodeToWrite)
+        {
+            // TODO db.removeItem(soul)?
+            continue;
         }
 
-        return true;
+        assertPutEntry(soul, nodeToWrite, adapterOptions);
+        nodes[soul] = nodeToWrite;
     }
-    catch (e)
+
+    if (diff && isFunction(db.putDiff))
     {
-        throw e;
+        await db.putDiff(nodes, diff);
     }
+    else if (isFunction(db.putMany))
+    {
+        await db.putMany(nodes);
+    }
+    else
+    {
+        for (const soul in nodes)
+        {
+            await db.put(soul, nodes[soul]);
+        }
+    }
+
+    return true;
 }
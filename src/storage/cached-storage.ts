@@ -0,0 +1,308 @@
+import { isDefined } from 'topgun-typed';
+import { TGCacheStats, TGGraphData, TGNode } from '../types';
+import { StorageListOptions, TGStorage } from './types';
+import { createListFilter, jsonByteLength, utf8ByteLength } from './utils';
+
+interface CacheEntry
+{
+    readonly size: number;
+    readonly node?: TGNode;
+    /** Souls of a cached list, their nodes are held by the node entries */
+    readonly souls?: string[];
+    readonly filter?: (name: string) => boolean;
+}
+
+/**
+ * Read-through, write-through cache in front of a storage, bounded by the serialized size of its entries.
+ *
+ * Nodes are cached by soul. Lists are cached as their souls and served while all of their nodes
+ * are cached. A write of a soul that is not cached may add it to cached lists, those lists are dropped
+ */
+export class CachedStorage implements TGStorage
+{
+    private readonly _entries: Map<string, CacheEntry>;
+    private readonly _lists: Set<string>;
+    private _bytes: number;
+    private _hits: number;
+    private _misses: number;
+    private _evictions: number;
+
+    /**
+     * Constructor
+     */
+    constructor(readonly storage: TGStorage, readonly maxBytes: number)
+    {
+        this._entries   = new Map();
+        this._lists     = new Set();
+        this._bytes     = 0;
+        this._hits      = 0;
+        this._misses    = 0;
+        this._evictions = 0;
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    async get(key: string): Promise<TGNode|null>
+    {
+        const cached = this._getNode(key);
+
+        if (cached)
+        {
+            this._hits++;
+            return cached;
+        }
+
+        this._misses++;
+        const node = await this.storage.get(key);
+
+        if (node)
+        {
+            this._setNode(key, node);
+        }
+
+        return node;
+    }
+
+    async getMany(keys: string[]): Promise<TGGraphData>
+    {
+        const result: TGGraphData = {};
+        const missing: string[]   = [];
+
+        for (const key of keys)
+        {
+            const cached = this._getNode(key);
+
+            if (cached)
+            {
+                result[key] = cached;
+            }
+            else
+            {
+                missing.push(key);
+            }
+        }
+
+        this._hits   += keys.length - missing.length;
+        this._misses += missing.length;
+
+        if (!missing.length)
+        {
+            return result;
+        }
+
+        const loaded = this.storage.getMany
+            ? await this.storage.getMany(missing)
+            : await this._getEach(missing);
+
+        for (const key of missing)
+        {
+            const node  = loaded[key] || null;
+            result[key] = node;
+
+            if (node)
+            {
+                this._setNode(key, node);
+            }
+        }
+
+        return result;
+    }
+
+    async list(options: StorageListOptions): Promise<TGGraphData>
+    {
+        const listKey = '*' + JSON.stringify([options?.prefix, options?.start, options?.end, !!options?.reverse, options?.limit]);
+        const cached  = this._entries.get(listKey);
+
+        if (cached && cached.souls.every(soul => this._entries.has('#' + soul)))
+        {
+            this._hits++;
+            this._touch(listKey, cached);
+
+            return cached.souls.reduce((result, soul) =>
+            {
+                result[soul] = this._getNode(soul);
+                return result;
+            }, {} as TGGraphData);
+        }
+
+        this._misses++;
+        const result = await this.storage.list(options);
+        const souls  = Object.keys(result).filter(soul => !!result[soul]);
+
+        souls.forEach(soul => this._setNode(soul, result[soul]));
+        this._set(listKey, {
+            size  : souls.reduce((size, soul) => size + utf8ByteLength(soul), listKey.length),
+            souls,
+            filter: createListFilter(options),
+        });
+
+        return result;
+    }
+
+    async put(key: string, value: TGNode): Promise<void>
+    {
+        await this._write({ [key]: value }, () => this.storage.put(key, value));
+    }
+
+    async putMany(data: TGGraphData): Promise<void>
+    {
+        await this._write(data, () => this.storage.putMany
+            ? this.storage.putMany(data)
+            : this._putEach(data),
+        );
+    }
+
+    async putDiff(nodes: TGGraphData, diff: TGGraphData): Promise<void>
+    {
+        await this._write(nodes, () =>
+        {
+            if (this.storage.putDiff)
+            {
+                return this.storage.putDiff(nodes, diff);
+            }
+
+            return this.storage.putMany ? this.storage.putMany(nodes) : this._putEach(nodes);
+        });
+    }
+
+    stats(): TGCacheStats
+    {
+        return {
+            hits     : this._hits,
+            misses   : this._misses,
+            evictions: this._evictions,
+            entries  : this._entries.size,
+            bytes    : this._bytes,
+            maxBytes : this.maxBytes,
+        };
+    }
+
+    clear(): void
+    {
+        this._entries.clear();
+        this._lists.clear();
+        this._bytes = 0;
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    private async _write(data: TGGraphData, write: () => Promise<void>): Promise<void>
+    {
+        const souls = Object.keys(data).filter(soul => !!data[soul]);
+
+        try
+        {
+            await write();
+        }
+        catch (e)
+        {
+            // Merges may have changed cached nodes in place, read them again from the storage
+            souls.forEach(soul => this._delete('#' + soul));
+            throw e;
+        }
+
+        const created = souls.filter(soul => !this._entries.has('#' + soul));
+
+        if (created.length)
+        {
+            this._lists.forEach((listKey) =>
+            {
+                const entry = this._entries.get(listKey);
+
+                if (entry && created.some(soul => entry.filter(soul)))
+                {
+                    this._delete(listKey);
+                }
+            });
+        }
+
+        souls.forEach(soul => this._setNode(soul, data[soul]));
+    }
+
+    private _getNode(soul: string): TGNode|undefined
+    {
+        const key   = '#' + soul;
+        const entry = this._entries.get(key);
+
+        if (!entry)
+        {
+            return undefined;
+        }
+
+        this._touch(key, entry);
+        return entry.node;
+    }
+
+    private _setNode(soul: string, node: TGNode): void
+    {
+        this._set('#' + soul, { size: utf8ByteLength(soul) + jsonByteLength(node), node });
+    }
+
+    private _set(key: string, entry: CacheEntry): void
+    {
+        this._delete(key);
+
+        if (entry.size > this.maxBytes)
+        {
+            return;
+        }
+
+        this._entries.set(key, entry);
+        this._bytes += entry.size;
+
+        if (isDefined(entry.souls))
+        {
+            this._lists.add(key);
+        }
+
+        while (this._bytes > this.maxBytes)
+        {
+            this._delete(this._entries.keys().next().value);
+            this._evictions++;
+        }
+    }
+
+    private _touch(key: string, entry: CacheEntry): void
+    {
+        this._entries.delete(key);
+        this._entries.set(key, entry);
+    }
+
+    private _delete(key: string): void
+    {
+        const entry = this._entries.get(key);
+
+        if (entry)
+        {
+            this._entries.delete(key);
+            this._lists.delete(key);
+            this._bytes -= entry.size;
+        }
+    }
+
+    private async _getEach(keys: string[]): Promise<TGGraphData>
+    {
+        const nodes = await Promise.all(keys.map(key => this.storage.get(key)));
+
+        return keys.reduce((result, key, i) =>
+        {
+            result[key] = nodes[i];
+            return result;
+        }, {} as TGGraphData);
+    }
+
+    private async _putEach(data: TGGraphData): Promise<void>
+    {
+        for (const key in data)
+        {
+            if (data[key])
+            {
+                await this.storage.put(key, data[key]);
+            }
+        }
+    }
+}
@@ -1,3 +1,5 @@
 export * from './types';
 export * from './constants';
-export * from './adapter';
\ No newline at end of file
+export * from './adapter';
+export * from './cached-storage';
+export * from './sharded-adapter';
\ No newline at end of file
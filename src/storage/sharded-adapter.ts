@@ -0,0 +1,171 @@
+import { isFunction, isNumber, isString } from 'topgun-typed';
+import { TGGraphAdapter, TGGraphData, TGOptionsGet } from '../types';
+import { lexicographicCompare, storageListOptionsFromGetOptions } from './utils';
+import { StorageListOptions } from './types';
+
+export interface TGAdapterShard
+{
+    /** First soul of the shard's range, inclusive. The first shard starts at the empty string */
+    start?: string;
+    adapter: TGGraphAdapter;
+}
+
+interface TGShardRange
+{
+    readonly start: string;
+    readonly end: string|undefined;
+    readonly adapter: TGGraphAdapter;
+}
+
+/**
+ * Spread souls over adapters by soul range.
+ *
+ * A shard holds the souls from its start up to the start of the next shard.
+ * Puts are split per shard and written concurrently, list reads query every shard
+ * overlapping the requested range and merge the results in soul order
+ */
+export function createShardedAdapter(shards: TGAdapterShard[]): TGGraphAdapter
+{
+    if (!Array.isArray(shards) || !shards.length)
+    {
+        throw new TypeError('At least one shard is expected.');
+    }
+
+    const sorted = shards
+        .map(shard => ({ start: shard.start || '', adapter: shard.adapter }))
+        .sort((a, b) => lexicographicCompare(a.start, b.start));
+    const ranges = sorted.map((shard, i): TGShardRange => ({
+        start  : shard.start,
+        end    : i + 1 < sorted.length ? sorted[i + 1].start : undefined,
+        adapter: shard.adapter,
+    }));
+
+    return {
+        get  : (opts: TGOptionsGet) => get(ranges, opts),
+        put  : (graphData: TGGraphData) => put(ranges, graphData),
+        close: async () =>
+        {
+            await Promise.all(ranges.map(range => isFunction(range.adapter.close) && range.adapter.close()));
+        },
+    };
+}
+
+/**
+ * Index of the shard holding the soul
+ */
+export function shardIndexOf(starts: readonly string[], soul: string): number
+{
+    let low  = 0;
+    let high = starts.length - 1;
+
+    while (low < high)
+    {
+        const mid = (low + high + 1) >> 1;
+
+        if (lexicographicCompare(starts[mid], soul) <= 0)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    return low;
+}
+
+async function get(ranges: TGShardRange[], opts: TGOptionsGet): Promise<TGGraphData>
+{
+    const listOptions = storageListOptionsFromGetOptions(opts);
+    const targets     = ranges.filter(range => isRangeOverlap(range, listOptions));
+
+    if (targets.length === 1)
+    {
+        return targets[0].adapter.get(opts);
+    }
+
+    const results   = await Promise.all(targets.map(range => range.adapter.get(opts)));
+    const direction = listOptions.reverse ? -1 : 1;
+    const merged    = results.reduce((graph: TGGraphData, result) =>
+    {
+        // A shard without the soul answers null, that must not hide the node of the shard holding it
+        for (const soul in result || {})
+        {
+            if (result[soul] || !(soul in graph))
+            {
+                graph[soul] = result[soul];
+            }
+        }
+        return graph;
+    }, {});
+    let souls       = Object.keys(merged).sort((a, b) => direction * lexicographicCompare(a, b));
+
+    if (isNumber(listOptions.limit) && souls.length > listOptions.limit)
+    {
+        souls = souls.slice(0, listOptions.limit);
+    }
+
+    return souls.reduce((graph, soul) =>
+    {
+        graph[soul] = merged[soul];
+        return graph;
+    }, {} as TGGraphData);
+}
+
+async function put(ranges: TGShardRange[], graphData: TGGraphData): Promise<TGGraphData|null>
+{
+    const starts  = ranges.map(range => range.start);
+    const batches = new Map<number, TGGraphData>();
+
+    for (const soul in graphData)
+    {
+        if (!soul)
+        {
+            continue;
+        }
+
+        const index = shardIndexOf(starts, soul);
+        const batch = batches.get(index) || {};
+        batch[soul] = graphData[soul];
+        batches.set(index, batch);
+    }
+
+    const diffs = await Promise.all(
+        [...batches].map(([index, batch]) => ranges[index].adapter.put(batch)),
+    );
+    const diff  = Object.assign({}, ...diffs.filter(value => !!value)) as TGGraphData;
+
+    return Object.keys(diff).length ? diff : null;
+}
+
+/**
+ * Whether the shard range [start, end) can hold souls matching the list options
+ */
+function isRangeOverlap(range: TGShardRange, options: StorageListOptions): boolean
+{
+    const { prefix, start, end } = options;
+
+    if (isString(end) && lexicographicCompare(range.start, end) >= 0)
+    {
+        return false;
+    }
+    if (isString(range.end) && isString(start) && lexicographicCompare(range.end, start) <= 0)
+    {
+        return false;
+    }
+    if (isString(prefix) && prefix.length)
+    {
+        // Souls with the prefix sort from the prefix up to the first string after them
+        if (isString(range.end) && lexicographicCompare(range.end, prefix) <= 0)
+        {
+            return false;
+        }
+        if (lexicographicCompare(range.start, prefix) > 0 && !range.start.startsWith(prefix))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,257 @@
+import { isNumber } from 'topgun-typed';
+import { StorageListOptions } from './types';
+import { lexicographicCompare } from './utils';
+
+interface SortedKeyNode
+{
+    key: string;
+    next: SortedKeyNode[];
+    prev: SortedKeyNode|null;
+}
+
+const MAX_LEVEL   = 32;
+const PROBABILITY = 0.25;
+
+/**
+ * Ordered set of keys in UTF-8 byte order, backed by a skip list.
+ *
+ * Answers prefix/start/end/reverse/limit range scans in O(log n + k)
+ */
+export class SortedKeyIndex
+{
+    private readonly _head: SortedKeyNode;
+    private readonly _update: SortedKeyNode[];
+    private _level: number;
+    private _size: number;
+
+    /**
+     * Constructor
+     */
+    constructor(keys?: Iterable<string>)
+    {
+        this._head   = { key: null, next: new Array(MAX_LEVEL).fill(null), prev: null };
+        this._update = new Array(MAX_LEVEL).fill(null);
+        this._level  = 1;
+        this._size   = 0;
+
+        if (keys)
+        {
+            for (const key of keys)
+            {
+                this.add(key);
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Accessors
+    // -----------------------------------------------------------------------------------------------------
+
+    get size(): number
+    {
+        return this._size;
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    has(key: string): boolean
+    {
+        const node = this._findLast(next => lexicographicCompare(next.key, key) < 0).next[0];
+        return !!node && node.key === key;
+    }
+
+    /**
+     * Insert key, returns false if the key is already present
+     */
+    add(key: string): boolean
+    {
+        const update = this._update;
+        let node     = this._head;
+
+        for (let i = this._level - 1; i >= 0; i--)
+        {
+            while (node.next[i] && lexicographicCompare(node.next[i].key, key) < 0)
+            {
+                node = node.next[i];
+            }
+            update[i] = node;
+        }
+
+        if (node.next[0] && node.next[0].key === key)
+        {
+            return false;
+        }
+
+        const level = randomLevel();
+
+        if (level > this._level)
+        {
+            for (let i = this._level; i < level; i++)
+            {
+                update[i] = this._head;
+            }
+            this._level = level;
+        }
+
+        const created: SortedKeyNode = {
+            key,
+            next: new Array(level),
+            prev: node === this._head ? null : node,
+        };
+
+        for (let i = 0; i < level; i++)
+        {
+            created.next[i]   = update[i].next[i];
+            update[i].next[i] = created;
+        }
+
+        if (created.next[0])
+        {
+            created.next[0].prev = created;
+        }
+
+        this._size++;
+        return true;
+    }
+
+    /**
+     * Remove key, returns false if the key was not present
+     */
+    delete(key: string): boolean
+    {
+        const update = this._update;
+        let node     = this._head;
+
+        for (let i = this._level - 1; i >= 0; i--)
+        {
+            while (node.next[i] && lexicographicCompare(node.next[i].key, key) < 0)
+            {
+                node = node.next[i];
+            }
+            update[i] = node;
+        }
+
+        const target = node.next[0];
+
+        if (!target || target.key !== key)
+        {
+            return false;
+        }
+
+        for (let i = 0; i < this._level && update[i].next[i] === target; i++)
+        {
+            update[i].next[i] = target.next[i];
+        }
+
+        if (target.next[0])
+        {
+            target.next[0].prev = target.prev;
+        }
+
+        while (this._level > 1 && !this._head.next[this._level - 1])
+        {
+            this._level--;
+        }
+
+        this._size--;
+        return true;
+    }
+
+    /**
+     * Keys matching list options, in the requested order
+     */
+    range(options?: StorageListOptions): string[]
+    {
+        const { prefix, start, end, reverse, limit } = options || {};
+        const max                                    = isNumber(limit) ? limit : Infinity;
+        const keys: string[]                         = [];
+
+        if (max <= 0)
+        {
+            return keys;
+        }
+
+        if (reverse)
+        {
+            // Last key that is below the end and not past the prefix block
+            let node = this._findLast(next =>
+                (end === undefined || lexicographicCompare(next.key, end) < 0) &&
+                (
+                    prefix === undefined ||
+                    next.key.startsWith(prefix) ||
+                    lexicographicCompare(next.key, prefix) < 0
+                )
+            );
+
+            while (node && node !== this._head && keys.length < max)
+            {
+                if (
+                    (start !== undefined && lexicographicCompare(node.key, start) < 0) ||
+                    (prefix !== undefined && !node.key.startsWith(prefix))
+                )
+                {
+                    break;
+                }
+                keys.push(node.key);
+                node = node.prev;
+            }
+
+            return keys;
+        }
+
+        // First key that is at or above both the start and the prefix
+        let node = this._findLast(next =>
+            (start !== undefined && lexicographicCompare(next.key, start) < 0) ||
+            (prefix !== undefined && lexicographicCompare(next.key, prefix) < 0)
+        ).next[0];
+
+        while (node && keys.length < max)
+        {
+            if (
+                (end !== undefined && lexicographicCompare(node.key, end) >= 0) ||
+                (prefix !== undefined && !node.key.startsWith(prefix))
+            )
+            {
+                break;
+            }
+            keys.push(node.key);
+            node = node.next[0];
+        }
+
+        return keys;
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Last node for which the predicate holds; the predicate must be monotone over the key order
+     */
+    private _findLast(predicate: (node: SortedKeyNode) => boolean): SortedKeyNode
+    {
+        let node = this._head;
+
+        for (let i = this._level - 1; i >= 0; i--)
+        {
+            while (node.next[i] && predicate(node.next[i]))
+            {
+                node = node.next[i];
+            }
+        }
+
+        return node;
+    }
+}
+
+function randomLevel(): number
+{
+    let level = 1;
+    while (level < MAX_LEVEL && Math.random() < PROBABILITY)
+    {
+        level++;
+    }
+    return level;
+}
@@ -7,6 +7,21 @@ export interface TGStorage
     get(key: string): Promise<TGNode|null>;
 
     list(options: StorageListOptions): Promise<TGGraphData>
+
+    /**
+     * Optional batch read, missing keys resolve to null.
+     * When implemented together with putMany, the adapter reads and writes a whole put in one round trip
+     */
+    getMany?(keys: string[]): Promise<TGGraphData>;
+
+    /** Optional batch write, should commit all nodes in one transaction */
+    putMany?(data: TGGraphData): Promise<void>;
+
+    /**
+     * Optional write of merged nodes together with the CRDT diff that produced them,
+     * preferred by the adapter. Log based storages persist the diff instead of the whole nodes
+     */
+    putDiff?(nodes: TGGraphData, diff: TGGraphData): Promise<void>;
 }
 
 export interface StorageListOptions
@@ -26,4 +41,4 @@ export interface StorageListOptions
     // Stage 3: paginating
     /** Maximum number of keys to return if defined */
     limit?: number;
-}
\ No newline at end of file
+}
@@ -1,21 +1,30 @@
-import { isNumber, isString, isDefined } from 'topgun-typed';
-import textEncoder from 'topgun-textencoder';
+import { isNumber, isString, isDefined, isFunction } from 'topgun-typed';
 import { MAX_KEY_SIZE, MAX_VALUE_SIZE } from './constants';
 import { LEX, TGGraphAdapterOptions, TGGraphData, TGNode, TGOptionsGet } from '../types';
 import { StorageListOptions } from './types';
 import { getNodeSoul } from '../utils/node';
 import { assertNotEmptyString } from '../utils/assert';
 
+const MAX_SIZE_DEPTH = 64;
+
 export function arrayNodesToObject(nodes: TGNode[]): TGGraphData
 {
-    return nodes.reduce((accum: TGGraphData, node: TGNode) => ({ ...accum, [node._['#']]: node }), {});
+    const result: TGGraphData = {};
+
+    for (const node of nodes)
+    {
+        result[node._['#']] = node;
+    }
+
+    return result;
 }
 
 export function filterNodesByListOptions(nodes: TGNode[], options: StorageListOptions): TGNode[]
 {
     const direction   = options?.reverse ? -1 : 1;
+    const filter      = createListFilter(options);
     let filteredNodes = nodes
-        .filter(node => listFilterMatch(options, getNodeSoul(node)))
+        .filter(node => filter(getNodeSoul(node)))
         .sort((a, b) => direction * lexicographicCompare(getNodeSoul(a), getNodeSoul(b)));
 
     if (isNumber(options?.limit) && filteredNodes.length > options?.limit)
@@ -35,6 +44,7 @@ export function storageListOptionsFromGetOptions(opts: TGOptionsGet): StorageLis
     const prefix: string|undefined   = lexQuery && lexQuery['*'];
     const start: string|undefined    = lexQuery && lexQuery['>'];
     const end: string|undefined      = lexQuery && lexQuery['<'];
+    const cursor: string|undefined   = opts && opts['$'];
 
     const getPath                     = (path: string) => [soul, path]
         .filter(value => value && value.length > 0)
@@ -59,10 +69,44 @@ export function storageListOptionsFromGetOptions(opts: TGOptionsGet): StorageLis
     {
         options.reverse = reverse;
     }
+    if (isString(cursor) && cursor.length)
+    {
+        applyListCursor(options, cursor);
+    }
+
+    return options;
+}
+
+/**
+ * Narrow a list to the souls after the cursor soul in list order, so a scan resumes with an index seek
+ */
+export function applyListCursor(options: StorageListOptions, cursor: string): StorageListOptions
+{
+    if (options.reverse)
+    {
+        // The end is exclusive
+        if (!isString(options.end) || lexicographicCompare(cursor, options.end) < 0)
+        {
+            options.end = cursor;
+        }
+    }
+    else
+    {
+        // The first string sorting after the cursor
+        const start = cursor + '\u0000';
+
+        if (!isString(options.start) || lexicographicCompare(start, options.start) > 0)
+        {
+            options.start = start;
+        }
+    }
 
     return options;
 }
 
+/**
+ * Check soul and node sizes before a write. The node size is its serialized size
+ */
 export function assertPutEntry(soul: string, node: TGNode, options: TGGraphAdapterOptions): void
 {
     const maxKeySize   = isNumber(options?.maxKeySize) ? options.maxKeySize : MAX_KEY_SIZE;
@@ -73,7 +117,7 @@ export function assertPutEntry(soul: string, node: TGNode, options: TGGraphAdapt
 
 export function assertKeySize(key: string, maxKeySize: number): void
 {
-    if (new Blob([key]).size <= maxKeySize)
+    if (utf8ByteLength(key) <= maxKeySize)
     {
         return;
     }
@@ -82,7 +126,7 @@ export function assertKeySize(key: string, maxKeySize: number): void
 
 export function assertValueSize(value: TGNode, maxValueSize: number, key?: string): void
 {
-    if (roughSizeOfObject(value) <= maxValueSize)
+    if (jsonByteLength(value) <= maxValueSize)
     {
         return;
     }
@@ -95,45 +139,172 @@ export function assertValueSize(value: TGNode, maxValueSize: number, key?: strin
     throw new RangeError(`Values cannot be larger than ${maxValueSize} bytes.`);
 }
 
-function roughSizeOfObject(object: object): number
+/**
+ * Byte length of a string encoded as UTF-8, lone surrogates count as U+FFFD
+ */
+export function utf8ByteLength(value: string): number
 {
-    const objectList = [];
-    const stack      = [object];
-    let bytes        = 0;
+    let bytes = value.length;
 
-    while (stack.length)
+    for (let i = 0; i < value.length; i++)
     {
-        const value: any = stack.pop();
+        const code = value.charCodeAt(i);
 
-        if (typeof value === 'boolean')
+        if (code < 0x80)
+        {
+            continue;
+        }
+        if (code < 0x800)
+        {
+            bytes += 1;
+        }
+        else if (code >= 0xd800 && code < 0xdc00 && isLowSurrogate(value.charCodeAt(i + 1)))
         {
-            bytes += 4;
+            // Two UTF-16 units, four bytes
+            bytes += 2;
+            i++;
         }
-        else if (typeof value === 'string')
+        else
         {
-            bytes += (value as string).length * 2;
+            bytes += 2;
         }
-        else if (typeof value === 'number')
+    }
+
+    return bytes;
+}
+
+/**
+ * Byte length of JSON.stringify(value) encoded as UTF-8, without serializing it
+ */
+export function jsonByteLength(value: unknown, depth = 0): number
+{
+    switch (typeof value)
+    {
+    case 'string':
+        return jsonStringByteLength(value);
+    case 'number':
+        return Number.isFinite(value) ? numberLength(value) : 4;
+    case 'boolean':
+        return value ? 4 : 5;
+    case 'object':
+        break;
+    default:
+        return 0;
+    }
+
+    if (value === null)
+    {
+        return 4;
+    }
+    if (depth > MAX_SIZE_DEPTH)
+    {
+        throw new RangeError('Values cannot be nested that deep.');
+    }
+    if (isFunction((value as any).toJSON))
+    {
+        return utf8ByteLength(JSON.stringify(value));
+    }
+
+    let bytes   = 2;
+    let entries = 0;
+
+    if (Array.isArray(value))
+    {
+        for (const item of value)
         {
-            bytes += 8;
+            // undefined and functions serialize as null in arrays
+            const size = jsonByteLength(item, depth + 1);
+            bytes     += size || 4;
+            entries++;
         }
-        else if
-        (
-            typeof value === 'object'
-            && objectList.indexOf(value) === -1
-        )
+    }
+    else
+    {
+        for (const key in value)
         {
-            objectList.push(value);
+            const item = value[key];
 
-            for (const i in value)
+            if (item === undefined || isFunction(item))
             {
-                stack.push(value[i]);
+                continue;
             }
+
+            bytes += jsonStringByteLength(key) + 1 + jsonByteLength(item, depth + 1);
+            entries++;
+        }
+    }
+
+    return entries ? bytes + entries - 1 : bytes;
+}
+
+function jsonStringByteLength(value: string): number
+{
+    let bytes = value.length + 2;
+
+    for (let i = 0; i < value.length; i++)
+    {
+        const code = value.charCodeAt(i);
+
+        if (code < 0x20)
+        {
+            // \b \t \n \f \r, otherwise \u00XX
+            bytes += code === 0x08 || code === 0x09 || code === 0x0a || code === 0x0c || code === 0x0d ? 1 : 5;
+        }
+        else if (code === 0x22 || code === 0x5c)
+        {
+            bytes += 1;
+        }
+        else if (code < 0x80)
+        {
+            continue;
+        }
+        else if (code < 0x800)
+        {
+            bytes += 1;
+        }
+        else if (code >= 0xd800 && code < 0xdc00 && isLowSurrogate(value.charCodeAt(i + 1)))
+        {
+            bytes += 2;
+            i++;
+        }
+        else if (code >= 0xd800 && code <= 0xdfff)
+        {
+            // Lone surrogates are escaped as \uXXXX
+            bytes += 5;
+        }
+        else
+        {
+            bytes += 2;
         }
     }
+
     return bytes;
 }
 
+function numberLength(value: number): number
+{
+    if (!Number.isSafeInteger(value))
+    {
+        return String(value).length;
+    }
+
+    let length = value < 0 ? 2 : 1;
+    let rest   = Math.abs(value);
+
+    while (rest >= 10)
+    {
+        rest = Math.floor(rest / 10);
+        length++;
+    }
+
+    return length;
+}
+
+function isLowSurrogate(code: number): boolean
+{
+    return code >= 0xdc00 && code <= 0xdfff;
+}
+
 export function arrayCompare<T extends any[]|NodeJS.TypedArray>(
     a: T,
     b: T
@@ -150,12 +321,49 @@ export function arrayCompare<T extends any[]|NodeJS.TypedArray>(
     return a.length - b.length;
 }
 
-// Compares x and y lexicographically using a UTF-8 collation
+/**
+ * Compares x and y lexicographically using a UTF-8 collation, without encoding either string.
+ * UTF-16 code units already sort in code point (and so UTF-8 byte) order, except that
+ * surrogates have to sort above U+E000..U+FFFF. Lone surrogates are compared as is
+ */
 export function lexicographicCompare(x: string, y: string): number
 {
-    const xEncoded = textEncoder.encode(x);
-    const yEncoded = textEncoder.encode(y);
-    return arrayCompare(xEncoded, yEncoded);
+    const length = Math.min(x.length, y.length);
+
+    for (let i = 0; i < length; i++)
+    {
+        let a = x.charCodeAt(i);
+        let b = y.charCodeAt(i);
+
+        if (a === b)
+        {
+            continue;
+        }
+        if (a >= 0xd800 && b >= 0xd800)
+        {
+            a = a >= 0xe000 ? a - 0x800 : a + 0x2000;
+            b = b >= 0xe000 ? b - 0x800 : b + 0x2000;
+        }
+        return a < b ? -1 : 1;
+    }
+
+    return x.length - y.length;
+}
+
+/**
+ * Build a matcher for list options once per query instead of reading the options on every key
+ */
+export function createListFilter(options: StorageListOptions|undefined): (name: string) => boolean
+{
+    const prefix = options?.prefix;
+    const start  = options?.start;
+    const end    = options?.end;
+
+    return name => isString(name) && !(
+        (prefix !== undefined && !name.startsWith(prefix)) ||
+        (start !== undefined && lexicographicCompare(name, start) < 0) ||
+        (end !== undefined && lexicographicCompare(name, end) >= 0)
+    );
 }
 
 export function listFilterMatch(
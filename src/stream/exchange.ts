@@ -1,6 +1,6 @@
 import { AsyncStreamEmitter, StreamDemux } from 'topgun-async-stream-emitter';
 import { TGStream } from './stream';
-import { TGSimpleStream, TGStreamState } from './types';
+import { TGDispatchMode, TGSimpleStream, TGStreamHandler, TGStreamState } from './types';
 import { uuidv4 } from '../utils/uuidv4';
 
 export class TGExchange extends AsyncStreamEmitter<any>
@@ -10,6 +10,8 @@ export class TGExchange extends AsyncStreamEmitter<any>
     private readonly _streamMap: {
         [key: string]: TGSimpleStream
     };
+    private readonly _handlers: Map<string, TGStreamHandler[]>;
+    private _pending: [TGStreamHandler, any][];
 
     /**
      * Constructor
@@ -18,6 +20,8 @@ export class TGExchange extends AsyncStreamEmitter<any>
     {
         super();
         this._streamMap        = {};
+        this._handlers         = new Map();
+        this._pending          = [];
         this._streamEventDemux = new StreamDemux();
         this._streamDataDemux  = new StreamDemux();
 
@@ -39,10 +43,46 @@ export class TGExchange extends AsyncStreamEmitter<any>
 
     publish(streamName: string, data: any): Promise<void>
     {
+        const handlers = this._handlers.get(streamName);
+
+        if (handlers && this._streamMap[streamName])
+        {
+            this._dispatch(handlers, data);
+        }
+
         this.emit('publish', { streamName, data });
         return Promise.resolve();
     }
 
+    /**
+     * Deliver the packets of a stream to a callback, without the promise hops of async iteration.
+     * Packets are delivered while the stream is subscribed, until it is destroyed
+     *
+     * @returns Function that removes the callback
+     */
+    listen(streamName: string, handler: (data: any) => void, mode: TGDispatchMode = 'sync'): () => void
+    {
+        const entry: TGStreamHandler = { handler, mode, active: true };
+        const handlers               = this._handlers.get(streamName) || [];
+
+        this._handlers.set(streamName, [...handlers, entry]);
+
+        return () =>
+        {
+            entry.active  = false;
+            const current = (this._handlers.get(streamName) || []).filter(value => value !== entry);
+
+            if (current.length)
+            {
+                this._handlers.set(streamName, current);
+            }
+            else
+            {
+                this._handlers.delete(streamName);
+            }
+        };
+    }
+
     stream(streamName: string, attributes: {[key: string]: any} = {}): TGStream<any>
     {
         const channelDataStream = this._streamDataDemux.stream(streamName);
@@ -67,6 +107,7 @@ export class TGExchange extends AsyncStreamEmitter<any>
                 this._triggerStreamDestroy(stream);
             }
 
+            this._removeHandlers(streamName);
             this._streamDataDemux.close(streamName);
             this._streamDataDemux.close(streamName);
         }
@@ -77,6 +118,7 @@ export class TGExchange extends AsyncStreamEmitter<any>
                 const stream = this._streamMap[streamName];
                 this._triggerStreamDestroy(stream);
             });
+            this._handlers.forEach((_, streamName) => this._removeHandlers(streamName));
             this.closeAllListeners();
             this._streamDataDemux.closeAll();
             this._streamEventDemux.closeAll();
@@ -146,6 +188,65 @@ export class TGExchange extends AsyncStreamEmitter<any>
     // @ Private methods
     // -----------------------------------------------------------------------------------------------------
 
+    private _dispatch(handlers: TGStreamHandler[], data: any): void
+    {
+        // Handlers added or removed by a handler take effect from the next packet
+        for (const entry of handlers)
+        {
+            if (entry.mode === 'sync')
+            {
+                this._invoke(entry, data);
+                continue;
+            }
+
+            if (!this._pending.length)
+            {
+                Promise.resolve().then(() => this._flush());
+            }
+            this._pending.push([entry, data]);
+        }
+    }
+
+    private _flush(): void
+    {
+        const pending = this._pending;
+        this._pending = [];
+
+        for (const [entry, data] of pending)
+        {
+            if (entry.active)
+            {
+                this._invoke(entry, data);
+            }
+        }
+    }
+
+    /**
+     * A throwing handler is reported, the other handlers and the stream listeners still get the packet
+     */
+    private _invoke(entry: TGStreamHandler, data: any): void
+    {
+        try
+        {
+            entry.handler(data);
+        }
+        catch (e)
+        {
+            console.warn('Stream handler error', e);
+        }
+    }
+
+    private _removeHandlers(streamName: string): void
+    {
+        const handlers = this._handlers.get(streamName);
+
+        if (handlers)
+        {
+            handlers.forEach(entry => entry.active = false);
+            this._handlers.delete(streamName);
+        }
+    }
+
     private _triggerStreamDestroy(stream: TGSimpleStream): void
     {
         const streamName = stream.name;
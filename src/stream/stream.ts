@@ -5,7 +5,7 @@ import {
     ConsumableStreamConsumer
 } from 'topgun-async-stream-emitter';
 import { uuidv4 } from '../utils/uuidv4';
-import { TGStreamState } from './types';
+import { TGDispatchMode, TGStreamState } from './types';
 import { TGExchange } from './exchange';
 
 export class TGStream<T> extends ConsumableStream<T>
@@ -73,6 +73,16 @@ export class TGStream<T> extends ConsumableStream<T>
         return this._dataStream.createConsumer(timeout);
     }
 
+    /**
+     * Deliver packets to a callback directly, the async iterator is left to consumers that need it
+     *
+     * @returns Function that removes the callback
+     */
+    listen(handler: (data: T) => void, mode: TGDispatchMode = 'sync'): () => void
+    {
+        return this.exchange.listen(this.name, handler, mode);
+    }
+
     subscribe(): void
     {
         this.exchange.subscribe(this.name);
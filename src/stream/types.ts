@@ -6,3 +6,13 @@ export interface TGSimpleStream
     state: TGStreamState;
     attributes: {[key: string]: any};
 }
+
+/** `sync` calls the handler inside `publish`, `microtask` calls it with the other packets of the tick in one microtask */
+export type TGDispatchMode = 'sync'|'microtask';
+
+export interface TGStreamHandler
+{
+    readonly handler: (data: any) => void;
+    readonly mode: TGDispatchMode;
+    active: boolean;
+}
@@ -50,12 +50,28 @@ export interface TGOptionsGet
     '%'?: number;
     /** true for reverse */
     '-'?: boolean;
+    /** Summaries of the nodes the requester already holds, unchanged fields are left out of the reply */
+    '^'?: TGGraphSummary;
+    /** Continuation cursor of a list reply, the list resumes after this soul */
+    '$'?: string;
+}
+
+/**
+ * Max state, field count and order independent hash of a node's fields
+ */
+export type TGNodeSummary = [number, number, number];
+
+export interface TGGraphSummary
+{
+    [soul: string]: TGNodeSummary;
 }
 
 export type TGOptionsPut = Partial<{
     opt: {
         /** certificate that gives other people write permission */ cert: string;
     };
+    /** Write nodes in chunks of this many as they are flattened, large puts start transmitting sooner */
+    chunkSize: number;
 
     [key: string]: any;
 }>;
@@ -64,7 +80,6 @@ export interface CRDTOpts
 {
     machineState?: number;
     futureGrace?: number;
-    Lexical?: (x: TGValue) => any;
 
     [k: string]: any;
 }
@@ -83,10 +98,53 @@ export interface TGMessage
     ack?: number|boolean;
     err?: any;
     ok?: boolean|number;
+    /** Cursor of the next page of a list reply, absent on the last page */
+    '$'?: string;
 }
 
 export type TGMessageCb = (msg: TGMessage) => void;
 
+/** Event carrying multiplexed frames over a single socket */
+export const TG_MUX_EVENT = 'topgun/mux';
+
+/**
+ * Batch of messages exchanged in multiplexed mode.
+ * Gets keep their soul of interest until released by their message id in `off`
+ */
+export interface TGMuxFrame
+{
+    msgs?: TGMessage[];
+    off?: string[];
+}
+
+/**
+ * Messages of one tick exchanged with a worker host.
+ * `auth` names the user a tab signed in as, the host refuses tabs of another user than its own.
+ * `close` releases the gets of the sending port, or tells a tab it was refused with `err`.
+ * `ping` keeps an otherwise idle port alive
+ */
+export interface TGWorkerFrame extends TGMuxFrame
+{
+    auth?: {
+        pub: string;
+    };
+    close?: boolean;
+    ping?: boolean;
+    err?: string;
+}
+
+/**
+ * Either end of a channel to a worker host: a Worker, a SharedWorker port or a worker scope
+ */
+export interface TGWorkerPort
+{
+    postMessage(frame: TGWorkerFrame): void;
+    addEventListener(type: 'message', listener: (event: { data: TGWorkerFrame }) => void): void;
+    /** Required by message ports before they deliver to listeners */
+    start?(): void;
+    close?(): void;
+}
+
 /**
  * How puts are communicated to connectors
  */
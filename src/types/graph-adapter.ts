@@ -1,14 +1,32 @@
 import { TGGraphData, TGOptionsGet } from './common';
+import { TGMetrics } from './metrics';
 
 export interface TGGraphAdapter
 {
-    readonly close?: () => void;
+    /** May resolve once pending writes are durable */
+    readonly close?: () => void|Promise<void>;
     readonly get: (opts: TGOptionsGet) => Promise<TGGraphData>;
     readonly put: (graphData: TGGraphData) => Promise<TGGraphData|null>;
+    /** Read cache counters, defined when the adapter has a read cache */
+    readonly cacheStats?: () => TGCacheStats;
 }
 
 export interface TGGraphAdapterOptions
 {
     maxKeySize?: number;
     maxValueSize?: number;
-}
\ No newline at end of file
+    /** Size in bytes of a read cache in front of the storage, no cache when unset */
+    readCacheSize?: number;
+    /** Sink for storage timings and retry counts */
+    metrics?: TGMetrics;
+}
+
+export interface TGCacheStats
+{
+    hits: number;
+    misses: number;
+    evictions: number;
+    entries: number;
+    bytes: number;
+    maxBytes: number;
+}
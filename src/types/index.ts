@@ -3,3 +3,4 @@ export * from './graph-adapter';
 export * from './lex';
 export * from './policy';
 
+export * from './metrics';
@@ -0,0 +1,32 @@
+export type TGMetricLabels = {[name: string]: string};
+
+/**
+ * Instrumentation sink for server and client hot paths, wrap a Prometheus, OpenTelemetry or StatsD client into it.
+ * Nothing is measured while no sink is configured
+ */
+export interface TGMetrics
+{
+    /** Record a value into a histogram, durations are in seconds */
+    observe(name: string, value: number, labels?: TGMetricLabels): void;
+    /** Increase a counter */
+    increment(name: string, value?: number, labels?: TGMetricLabels): void;
+    /** Set a gauge */
+    gauge(name: string, value: number, labels?: TGMetricLabels): void;
+    /** Drop a series whose subject is gone, like a closed socket */
+    remove?(name: string, labels?: TGMetricLabels): void;
+    /** Register a function updating gauges that are computed when metrics are read */
+    addCollector?(collect: () => void): void;
+}
+
+/** Put durations by `stage`: validate, verify, storage, publish */
+export const TG_METRIC_PUT_SECONDS = 'topgun_put_stage_seconds';
+/** Get durations by `stage`: storage, filter */
+export const TG_METRIC_GET_SECONDS = 'topgun_get_stage_seconds';
+/** Graph adapter put durations by `op`: read, merge, write */
+export const TG_METRIC_STORAGE_SECONDS = 'topgun_storage_seconds';
+/** Messages waiting in a connector queue, by `connector` and `queue`: input, output */
+export const TG_METRIC_QUEUE_DEPTH = 'topgun_connector_queue_depth';
+/** Sockets subscribed to a soul, by `soul` and `transport`: channel, mux */
+export const TG_METRIC_SOUL_SUBSCRIPTIONS = 'topgun_soul_subscriptions';
+/** Bytes sent and received by a server socket, by `socket` and `direction`: in, out */
+export const TG_METRIC_SOCKET_BYTES = 'topgun_socket_bytes_total';
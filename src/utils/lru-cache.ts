@@ -0,0 +1,71 @@
+/**
+ * Bounded map that evicts the least recently used entry once it is full
+ */
+export class LRUCache<K, V>
+{
+    private readonly _map: Map<K, V>;
+
+    /**
+     * Constructor
+     */
+    constructor(readonly maxSize: number)
+    {
+        this._map = new Map();
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Accessors
+    // -----------------------------------------------------------------------------------------------------
+
+    get size(): number
+    {
+        return this._map.size;
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    has(key: K): boolean
+    {
+        return this._map.has(key);
+    }
+
+    get(key: K): V|undefined
+    {
+        if (!this._map.has(key))
+        {
+            return undefined;
+        }
+
+        // Re-insert to mark the entry as most recently used
+        const value = this._map.get(key) as V;
+        this._map.delete(key);
+        this._map.set(key, value);
+
+        return value;
+    }
+
+    set(key: K, value: V): LRUCache<K, V>
+    {
+        this._map.delete(key);
+        this._map.set(key, value);
+
+        while (this._map.size > this.maxSize)
+        {
+            this._map.delete(this._map.keys().next().value);
+        }
+
+        return this;
+    }
+
+    delete(key: K): boolean
+    {
+        return this._map.delete(key);
+    }
+
+    clear(): void
+    {
+        this._map.clear();
+    }
+}
@@ -0,0 +1,27 @@
+/**
+ * Map items with an async function, running at most `concurrency` calls at a time.
+ * Results keep the order of the items
+ */
+export async function mapConcurrent<T, R>(
+    items: readonly T[],
+    concurrency: number,
+    fn: (item: T, index: number) => Promise<R>,
+): Promise<R[]>
+{
+    const results: R[] = new Array(items.length);
+    let next           = 0;
+
+    const worker = async (): Promise<void> =>
+    {
+        while (next < items.length)
+        {
+            const index    = next++;
+            results[index] = await fn(items[index], index);
+        }
+    };
+
+    const workers = Math.max(1, Math.min(concurrency, items.length));
+    await Promise.all(Array.from({ length: workers }, worker));
+
+    return results;
+}
@@ -0,0 +1,25 @@
+import { TGMetricLabels, TGMetrics } from '../types';
+
+/**
+ * Start of a timed section, only reads the clock when metrics are enabled
+ */
+export function metricsNow(metrics: TGMetrics|undefined): number
+{
+    return metrics ? performance.now() : 0;
+}
+
+/**
+ * Record the seconds since `start` into a histogram
+ */
+export function observeSince(
+    metrics: TGMetrics|undefined,
+    name: string,
+    start: number,
+    labels?: TGMetricLabels,
+): void
+{
+    if (metrics)
+    {
+        metrics.observe(name, (performance.now() - start) / 1000, labels);
+    }
+}
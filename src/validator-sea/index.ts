@@ -0,0 +1,148 @@
+import { err, isObject, isString, ok, Result, StructError } from 'topgun-typed';
+import { parse, prep, pubFromSoul } from '../sea';
+import { TGGraphData, TGNode } from '../types';
+import { LRUCache } from '../utils/lru-cache';
+import { TGVerifyItem, TGVerifyPool } from './verify-pool';
+
+export * from './verify-pool';
+
+export interface TGSeaValidatorOptions
+{
+    /** Worker threads verifying signatures, 0 verifies on the event loop. Defaults to 2 */
+    workers?: number;
+    /** Maximum number of verified fields remembered, 10000 by default */
+    cacheSize?: number;
+    /** How long in ms a verified field is remembered, 60 seconds by default */
+    cacheTTL?: number;
+}
+
+interface TGSignedField
+{
+    readonly soul: string;
+    readonly key: string;
+    readonly cacheKey: string;
+    readonly item: TGVerifyItem;
+}
+
+/**
+ * Checks that every field written to a user soul (`~pub...`) is signed by that pub
+ */
+export class TGSeaValidator
+{
+    private readonly _pool: TGVerifyPool;
+    private readonly _verified: LRUCache<string, number>;
+    private readonly _cacheTTL: number;
+
+    /**
+     * Constructor
+     */
+    constructor(options?: TGSeaValidatorOptions)
+    {
+        const { workers = 2, cacheSize = 10000, cacheTTL = 60 * 1000 } = options || {};
+
+        this._pool     = new TGVerifyPool(workers);
+        this._verified = new LRUCache(cacheSize);
+        this._cacheTTL = cacheTTL;
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    async validate(graph: TGGraphData): Promise<Result<TGGraphData>>
+    {
+        const byPub = new Map<string, TGSignedField[]>();
+        const now   = new Date().getTime();
+
+        for (const soul in graph)
+        {
+            const node = graph[soul];
+            const pub  = pubFromSoul(soul);
+
+            if (!pub || !node)
+            {
+                continue;
+            }
+
+            for (const key in node)
+            {
+                // The pub of an account node is stored unsigned
+                if (key === '_' || (key === 'pub' && soul === `~${pub}`))
+                {
+                    continue;
+                }
+
+                const signed = parse(node[key]);
+
+                if (!isObject(signed) || !isString(signed['~']))
+                {
+                    return signatureError('Signature is missing', node, soul, key);
+                }
+
+                // The signature stands for the signed text, the packed length tells re-packed values apart.
+                // A value reusing a remembered signature carries the state of the verified write,
+                // so the merge keeps the verified value on that tie
+                const state    = (node._ && node._['>'] && node._['>'][key]) || 0;
+                const length   = isString(node[key]) ? node[key].length : 0;
+                const cacheKey = `${soul}\u0000${key}\u0000${state}\u0000${signed['~']}\u0000${length}`;
+                const expires  = this._verified.get(cacheKey);
+
+                if (expires && expires > now)
+                {
+                    continue;
+                }
+
+                const fields = byPub.get(pub) || [];
+                fields.push({
+                    soul,
+                    key,
+                    cacheKey,
+                    item: {
+                        text     : JSON.stringify(prep(signed[':'], key, node, soul)),
+                        signature: signed['~'],
+                    },
+                });
+                byPub.set(pub, fields);
+            }
+        }
+
+        const checks = await Promise.all(
+            [...byPub].map(async ([pub, fields]) =>
+            {
+                const results = await this._pool.verify(pub, fields.map(field => field.item));
+                return fields.find((_field, index) => !results[index]);
+            }),
+        );
+        const invalid = checks.find(Boolean);
+
+        if (invalid)
+        {
+            return signatureError('Invalid signature', graph[invalid.soul], invalid.soul, invalid.key);
+        }
+
+        const expires = new Date().getTime() + this._cacheTTL;
+        byPub.forEach(fields => fields.forEach(field => this._verified.set(field.cacheKey, expires)));
+
+        return ok(graph);
+    }
+
+    close(): Promise<void>
+    {
+        return this._pool.close();
+    }
+}
+
+export function createSeaValidator(options?: TGSeaValidatorOptions): TGSeaValidator
+{
+    return new TGSeaValidator(options);
+}
+
+function signatureError(message: string, node: TGNode, soul: string, key: string): Result<TGGraphData>
+{
+    return err(
+        new StructError(message, {
+            input: node,
+            path : [soul, key],
+        }),
+    );
+}
@@ -0,0 +1,211 @@
+import { sha256, verifyMany } from '../sea';
+
+export interface TGVerifyItem
+{
+    /** Serialized message the signature was made for */
+    readonly text: string;
+    /** Base64 ECDSA signature */
+    readonly signature: string;
+}
+
+interface TGPoolWorker
+{
+    readonly worker: any;
+    readonly jobs: Map<number, {resolve: (results: boolean[]) => void; reject: (error: unknown) => void}>;
+}
+
+/**
+ * Runs in each worker: hash and verify a batch of items signed by one pub
+ */
+const WORKER_SOURCE = `
+const { parentPort } = require('worker_threads');
+const { webcrypto } = require('crypto');
+const keys = new Map();
+
+function importKey(pub) {
+    let key = keys.get(pub);
+    if (!key) {
+        const [x, y] = pub.split('.');
+        key = webcrypto.subtle.importKey('jwk', { kty: 'EC', crv: 'P-256', x, y, ext: true }, { name: 'ECDSA', namedCurve: 'P-256' }, false, ['verify']);
+        key.catch(() => keys.delete(pub));
+        if (keys.size >= 1000) keys.delete(keys.keys().next().value);
+        keys.set(pub, key);
+    }
+    return key;
+}
+
+async function verify(key, item) {
+    try {
+        const hash = await webcrypto.subtle.digest('SHA-256', Buffer.from(item.text, 'utf8'));
+        return await webcrypto.subtle.verify({ name: 'ECDSA', hash: { name: 'SHA-256' } }, key, Buffer.from(item.signature, 'base64'), new Uint8Array(hash));
+    } catch (e) {
+        return false;
+    }
+}
+
+parentPort.on('message', async ({ id, pub, items }) => {
+    let results;
+    try {
+        const key = await importKey(pub);
+        results = await Promise.all(items.map(item => verify(key, item)));
+    } catch (e) {
+        results = items.map(() => false);
+    }
+    parentPort.postMessage({ id, results });
+});
+`;
+
+/**
+ * Pool of worker threads verifying ECDSA signatures off the event loop.
+ * Without worker_threads (or with size 0) signatures are verified on the calling thread
+ */
+export class TGVerifyPool
+{
+    private _workers: Promise<TGPoolWorker[]>|undefined;
+    private _nextId: number;
+
+    /**
+     * Constructor
+     */
+    constructor(readonly size: number)
+    {
+        this._nextId = 0;
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Verify items signed by pub, resolves to one result per item
+     */
+    async verify(pub: string, items: readonly TGVerifyItem[]): Promise<boolean[]>
+    {
+        if (!items.length)
+        {
+            return [];
+        }
+
+        const workers = await this._getWorkers();
+
+        if (!workers.length)
+        {
+            return verifyOnThread(pub, items);
+        }
+
+        // Least busy worker
+        const target = workers.reduce((best, current) =>
+            current.jobs.size < best.jobs.size ? current : best,
+        );
+        const id     = this._nextId++;
+
+        return new Promise<boolean[]>((resolve, reject) =>
+        {
+            // Busy workers keep the process alive until their jobs are answered
+            if (!target.jobs.size)
+            {
+                target.worker.ref();
+            }
+            target.jobs.set(id, { resolve, reject });
+            target.worker.postMessage({ id, pub, items });
+        });
+    }
+
+    async close(): Promise<void>
+    {
+        if (!this._workers)
+        {
+            return;
+        }
+
+        const workers = await this._workers;
+        this._workers = Promise.resolve([]);
+
+        await Promise.all(workers.map(({ worker }) => worker.terminate()));
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    private _getWorkers(): Promise<TGPoolWorker[]>
+    {
+        if (!this._workers)
+        {
+            this._workers = this._spawn();
+        }
+        return this._workers;
+    }
+
+    private async _spawn(): Promise<TGPoolWorker[]>
+    {
+        if (!(this.size > 0))
+        {
+            return [];
+        }
+
+        let Worker: any;
+
+        try
+        {
+            Worker = (await import('worker_threads')).Worker;
+        }
+        catch (e)
+        {
+            return [];
+        }
+
+        const workers: TGPoolWorker[] = [];
+
+        for (let i = 0; i < this.size; i++)
+        {
+            // The script is CommonJS, so flags such as --input-type=module are not inherited
+            const poolWorker: TGPoolWorker = {
+                worker: new Worker(WORKER_SOURCE, { eval: true, execArgv: [] }),
+                jobs  : new Map(),
+            };
+
+            poolWorker.worker.on('message', ({ id, results }) =>
+            {
+                const job = poolWorker.jobs.get(id);
+
+                if (job)
+                {
+                    poolWorker.jobs.delete(id);
+                    job.resolve(results);
+                }
+                if (!poolWorker.jobs.size)
+                {
+                    poolWorker.worker.unref();
+                }
+            });
+            poolWorker.worker.on('error', (error) =>
+            {
+                // A crashed worker leaves the pool, its pending jobs fail
+                const index = workers.indexOf(poolWorker);
+
+                if (index !== -1)
+                {
+                    workers.splice(index, 1);
+                }
+                poolWorker.jobs.forEach(job => job.reject(error));
+                poolWorker.jobs.clear();
+            });
+            poolWorker.worker.unref();
+
+            workers.push(poolWorker);
+        }
+
+        return workers;
+    }
+}
+
+async function verifyOnThread(pub: string, items: readonly TGVerifyItem[]): Promise<boolean[]>
+{
+    const hashes = await Promise.all(items.map(async ({ text, signature }) => ({
+        hash: (await sha256(text)).toString('hex'),
+        signature,
+    })));
+
+    return verifyMany(hashes, pub);
+}
@@ -117,3 +117,115 @@ export const createValidator =
 
                          return isOk(result) ? ok(graph) : result;
                      };
+
+/**
+ * Same results as createValidator, for graphs that pass it the check is a single loop per node
+ * without building structs or copying nodes. Anything else goes through createValidator for the error
+ */
+export const createFastValidator =
+                 (msg = 'Root graph must be object'): Struct<TGGraphData> =>
+                 {
+                     const validator = createValidator(msg);
+
+                     return (graph: unknown) => isValidGraph(graph) ? ok(graph as TGGraphData) : validator(graph);
+                 };
+
+function isValidGraph(graph: unknown): boolean
+{
+    if (!isObject(graph))
+    {
+        return false;
+    }
+
+    for (const soul in graph)
+    {
+        if (!isValidNode(graph[soul], graph))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+function isValidNode(node: unknown, graph: object): boolean
+{
+    if (!isObject(node) || !isObject(node._) || !isObject(node._['>']) || !isString(node._['#']))
+    {
+        return false;
+    }
+    if (!isObject(graph[node._['#']]))
+    {
+        return false;
+    }
+
+    const state = node._['>'];
+    let keys    = 0;
+
+    for (const key in node)
+    {
+        if (key === '_')
+        {
+            continue;
+        }
+
+        const value = node[key];
+
+        if (!isValidValue(value) || !isFiniteNumber(state[key]))
+        {
+            return false;
+        }
+        keys++;
+    }
+
+    // Every value has a state, so the state must not hold any other key
+    for (const _key in state)
+    {
+        if (--keys < 0)
+        {
+            return false;
+        }
+    }
+
+    return keys === 0;
+}
+
+function isValidValue(value: unknown): boolean
+{
+    switch (typeof value)
+    {
+    case 'string':
+    case 'boolean':
+        return true;
+    case 'number':
+        return Number.isFinite(value);
+    case 'object':
+        if (value === null)
+        {
+            return true;
+        }
+        return isObject(value) && isString(value['#']) && hasSingleKey(value);
+    default:
+        return false;
+    }
+}
+
+function isFiniteNumber(value: unknown): boolean
+{
+    return typeof value === 'number' && Number.isFinite(value);
+}
+
+function hasSingleKey(value: object): boolean
+{
+    let count = 0;
+
+    for (const _key in value)
+    {
+        if (++count > 1)
+        {
+            return false;
+        }
+    }
+
+    return count === 1;
+}
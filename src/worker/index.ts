@@ -0,0 +1,3 @@
+export * from './worker-host';
+export * from '../client/transports/worker-graph-connector';
+export * from '../types';
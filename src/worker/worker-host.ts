@@ -0,0 +1,424 @@
+import { isFunction, isNumber, isObject } from 'topgun-typed';
+import { AsyncStreamEmitter } from 'topgun-async-stream-emitter';
+import { diffCRDT } from '../crdt';
+import { TGGraph } from '../client/graph/graph';
+import { TGGraphConnector } from '../client/transports/graph-connector';
+import { createPeerConnectors } from '../client/transports/web-socket-graph-connector';
+import { mergeWorkerFrames } from '../client/transports/worker-graph-connector';
+import { DEFAULT_OPTIONS, TGClientOptions } from '../client/client-options';
+import { TGIndexedDBConnector } from '../indexeddb/indexeddb-connector';
+import { TGGraphData, TGMessage, TGNode, TGWorkerFrame, TGWorkerPort } from '../types';
+import { getNodeSoul } from '../utils/node';
+import { uuidv4 } from '../utils/uuidv4';
+import globalScope from '../utils/window-or-global';
+
+/** Graph and connector options of a client, user and session options stay with the tabs */
+export type TGWorkerHostOptions = Pick<TGClientOptions,
+    'peers'|'connectors'|'peerConnectorOptions'|'localStorage'|'localStorageKey'|'localStorageOptions'|
+    'graphMemoryBudget'|'spillEvictedNodes'|'maxKeySize'|'maxValueSize'> & {
+    /**
+     * Milliseconds a port may stay silent before its gets are released, 0 never releases them.
+     * Connected tabs send a heartbeat, a silent port belongs to a tab that closed or crashed
+     */
+    portTimeout?: number;
+};
+
+/** Three missed heartbeats of `TGWorkerGraphConnector` */
+export const DEFAULT_PORT_TIMEOUT = 15000;
+
+/** Scope of a SharedWorker, hands out a port per connecting tab */
+export interface TGSharedWorkerScope
+{
+    onconnect: unknown;
+    addEventListener(type: 'connect', listener: (event: { ports: readonly TGWorkerPort[] }) => void): void;
+}
+
+interface TGWorkerSession
+{
+    readonly port: TGWorkerPort;
+    /** Release functions of the active gets by message id */
+    readonly gets: Map<string, () => void>;
+    frame: TGWorkerFrame|null;
+    /** Time of the last frame received from the port */
+    seen: number;
+    /** User the tab signed in as, null while anonymous */
+    pub: string|null;
+}
+
+/**
+ * Graph and connectors shared by the tabs connected through `TGWorkerGraphConnector`.
+ *
+ * Gets of a tab become queries of the host graph, so tabs reading a soul share one peer request
+ * and every change is forwarded to each of them. Puts are written to the host graph
+ * and sent to its peers from there. Ports silent for longer than `portTimeout` are released,
+ * so the gets of a closed or crashed tab do not hold host queries forever.
+ *
+ * The peers of the host are shared, so they are signed in as one user. The worker signs them in
+ * with `authenticate`, tabs only tell which user they signed in as and never hand their keys over.
+ * A tab of another user, or a signed in tab while the host has no user, is refused
+ */
+export class TGWorkerHost extends AsyncStreamEmitter<any>
+{
+    readonly options: TGWorkerHostOptions;
+    readonly graph: TGGraph;
+    readonly portTimeout: number;
+
+    private readonly _sessions: Set<TGWorkerSession>;
+    private _sweepTimer: ReturnType<typeof setInterval>|null;
+    private _pub: string|null;
+
+    /**
+     * Constructor
+     */
+    constructor(options?: TGWorkerHostOptions)
+    {
+        super();
+        this.options     = { ...DEFAULT_OPTIONS, ...(isObject(options) ? options : {}) };
+        this.graph       = new TGGraph(this);
+        this.portTimeout = isNumber(this.options.portTimeout) && this.options.portTimeout >= 0
+            ? this.options.portTimeout
+            : DEFAULT_PORT_TIMEOUT;
+        this._sessions   = new Set();
+        this._sweepTimer = null;
+        this._pub        = null;
+
+        this.graph.use(diffCRDT);
+        this.graph.use(diffCRDT, 'write');
+
+        createPeerConnectors(this.options.peers, this.options.peerConnectorOptions).forEach(connector =>
+            this._useConnector(connector),
+        );
+        if (this.options.localStorage)
+        {
+            const connector = new TGIndexedDBConnector(
+                this.options.localStorageKey,
+                this.options,
+                this.options.localStorageOptions,
+            );
+
+            this._useConnector(connector);
+            if (this.options.spillEvictedNodes)
+            {
+                this.graph.opt({ spillTo: connector });
+            }
+        }
+        if (isNumber(this.options.graphMemoryBudget))
+        {
+            this.graph.opt({ memoryBudget: this.options.graphMemoryBudget });
+        }
+        this.options.connectors.forEach(connector => this._useConnector(connector));
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Accessors
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Ports currently served
+     */
+    get portCount(): number
+    {
+        return this._sessions.size;
+    }
+
+    /**
+     * User the peers are signed in as, null until `authenticate`
+     */
+    get pub(): string|null
+    {
+        return this._pub;
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Public methods
+    // -----------------------------------------------------------------------------------------------------
+
+    /**
+     * Serve a tab through its port
+     *
+     * @returns A function to be called to release the gets of the port
+     */
+    connect(port: TGWorkerPort): () => void
+    {
+        const session: TGWorkerSession = { port, gets: new Map(), frame: null, seen: Date.now(), pub: null };
+
+        this._sessions.add(session);
+        port.addEventListener('message', event => this._receive(session, event.data));
+        this._startSweep();
+
+        if (isFunction(port.start))
+        {
+            port.start();
+        }
+
+        return () => this._closeSession(session);
+    }
+
+    /**
+     * Sign the peers in as the user of the host, tabs signed in as another user are refused
+     */
+    async authenticate(pub: string, priv: string): Promise<void>
+    {
+        this._pub = pub;
+        this._sessions.forEach((session) =>
+        {
+            if (session.pub && session.pub !== pub)
+            {
+                this._refuse(session);
+            }
+        });
+
+        try
+        {
+            await this.graph.eachConnector(async (connector) =>
+            {
+                await connector.authenticate(pub, priv);
+            });
+        }
+        catch (e)
+        {
+            console.warn('Worker host authentication error', e);
+        }
+    }
+
+    /**
+     * Release all ports and close the connectors
+     */
+    async close(): Promise<void>
+    {
+        this._sessions.forEach(session => this._closeSession(session));
+
+        await this.graph.eachConnector(async (connector) =>
+        {
+            await connector.disconnect();
+        });
+        this.closeAllListeners();
+    }
+
+    // -----------------------------------------------------------------------------------------------------
+    // @ Private methods
+    // -----------------------------------------------------------------------------------------------------
+
+    private _useConnector(connector: TGGraphConnector): void
+    {
+        connector.sendPutsFromGraph(this.graph);
+        connector.sendRequestsFromGraph(this.graph);
+        this.graph.connect(connector);
+    }
+
+    private _receive(session: TGWorkerSession, frame: TGWorkerFrame): void
+    {
+        if (!frame || !this._sessions.has(session))
+        {
+            return;
+        }
+        session.seen = Date.now();
+
+        if (frame.auth)
+        {
+            session.pub = frame.auth.pub;
+
+            if (session.pub !== this._pub)
+            {
+                this._refuse(session);
+                return;
+            }
+        }
+        (frame.msgs || []).forEach((msg) =>
+        {
+            if (msg && msg.get)
+            {
+                this._get(session, msg);
+            }
+            else if (msg && msg.put)
+            {
+                this._put(session, msg);
+            }
+        });
+        (frame.off || []).forEach(msgId => this._release(session, msgId));
+
+        if (frame.close)
+        {
+            this._closeSession(session);
+        }
+    }
+
+    private _get(session: TGWorkerSession, msg: TGMessage): void
+    {
+        const msgId = msg['#'];
+
+        if (!msgId || session.gets.has(msgId))
+        {
+            return;
+        }
+
+        // The summary covers the nodes of the tab, the host summarizes its own nodes for its peers
+        const { '^': _summary, ...options } = msg.get;
+        const soul                          = options['#'];
+        const cached                        = this.graph.nodes;
+        const reply                         = (node: TGNode|undefined) => this._send(session, {
+            '#'  : uuidv4(),
+            '@'  : msgId,
+            'put': { [getNodeSoul(node) || soul]: node || null },
+        });
+
+        // A query already answered without a node does not answer again
+        if (!options['.'] && soul in cached && !cached[soul])
+        {
+            reply(undefined);
+        }
+
+        session.gets.set(msgId, this.graph.queryMany(options, reply, uuidv4()));
+    }
+
+    private _put(session: TGWorkerSession, msg: TGMessage): void
+    {
+        const msgId = msg['#'];
+        const ack   = (reply: TGMessage) => this._send(session, { ...reply, '#': uuidv4(), '@': msgId });
+
+        // Nothing new for the host, so nothing goes to the peers that would acknowledge it
+        if (!diffCRDT(msg.put, this.graph.nodes as TGGraphData))
+        {
+            ack({ err: null, ok: true });
+            return;
+        }
+
+        let local = true;
+
+        this.graph.put(msg.put, (reply) =>
+        {
+            // The first ack is the host graph's own, the tab acknowledged its write itself
+            if (local)
+            {
+                local = false;
+                return;
+            }
+            ack(reply);
+        });
+    }
+
+    private _release(session: TGWorkerSession, msgId: string): void
+    {
+        const release = session.gets.get(msgId);
+
+        if (release)
+        {
+            session.gets.delete(msgId);
+            release();
+        }
+    }
+
+    private _closeSession(session: TGWorkerSession): void
+    {
+        session.gets.forEach(release => release());
+        session.gets.clear();
+        this._sessions.delete(session);
+
+        if (!this._sessions.size)
+        {
+            this._stopSweep();
+        }
+    }
+
+    /**
+     * Release a tab signed in as another user than the host's and tell it why
+     */
+    private _refuse(session: TGWorkerSession): void
+    {
+        this._closeSession(session);
+        session.port.postMessage({
+            close: true,
+            err  : this._pub
+                ? `Worker host is signed in as ${this._pub}`
+                : 'Worker host is not signed in',
+        });
+    }
+
+    /**
+     * Release the ports that stayed silent for longer than the port timeout
+     */
+    private _sweep(): void
+    {
+        const deadline = Date.now() - this.portTimeout;
+
+        this._sessions.forEach((session) =>
+        {
+            if (session.seen < deadline)
+            {
+                this._closeSession(session);
+                if (isFunction(session.port.close))
+                {
+                    session.port.close();
+                }
+            }
+        });
+    }
+
+    private _startSweep(): void
+    {
+        if (this.portTimeout > 0 && !this._sweepTimer)
+        {
+            this._sweepTimer = setInterval(() => this._sweep(), Math.max(Math.floor(this.portTimeout / 3), 1));
+        }
+    }
+
+    private _stopSweep(): void
+    {
+        if (this._sweepTimer)
+        {
+            clearInterval(this._sweepTimer);
+            this._sweepTimer = null;
+        }
+    }
+
+    /**
+     * Replies to a port are posted once per tick
+     */
+    private _send(session: TGWorkerSession, msg: TGMessage): void
+    {
+        if (!this._sessions.has(session))
+        {
+            return;
+        }
+
+        if (!session.frame)
+        {
+            session.frame = {};
+            Promise.resolve().then(() =>
+            {
+                const pending = session.frame;
+                session.frame = null;
+
+                if (this._sessions.has(session))
+                {
+                    session.port.postMessage(pending);
+                }
+            });
+        }
+
+        mergeWorkerFrames(session.frame, { msgs: [msg] });
+    }
+}
+
+/**
+ * Serve the tabs of the current worker. A SharedWorker serves every tab connecting to it,
+ * a dedicated worker serves the page that started it
+ */
+export function startWorkerHost(
+    options?: TGWorkerHostOptions,
+    scope: TGWorkerPort|TGSharedWorkerScope = globalScope as any,
+): TGWorkerHost
+{
+    const host = new TGWorkerHost(options);
+
+    if ('onconnect' in scope)
+    {
+        scope.addEventListener('connect', event => event.ports.forEach(port => host.connect(port)));
+    }
+    else
+    {
+        host.connect(scope);
+    }
+
+    return host;
+}
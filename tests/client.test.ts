@@ -1,8 +1,11 @@
 import { isEmptyObject } from 'topgun-typed';
-import { diffCRDT, TGClient, TGUserReference, TGLink } from '../src/client';
+import { diffCRDT, filterGraphBySummary, summarizeNode, TGClient, TGUserReference, TGLink } from '../src/client';
 import { genString } from './test-util';
 import { TGLexLink } from '../src/client/lex-link';
 import { wait } from '../src/utils/wait';
+import { flattenGraphByPath, flattenGraphByPathChunks, getPathData } from '../src/client/graph/graph-utils';
+import { TGGraphQuery } from '../src/client/graph/graph-query';
+import { TGGraphQueryIndex } from '../src/client/graph/graph-query-index';
 
 describe('Client', () =>
 {
@@ -37,6 +40,171 @@ describe('Client', () =>
         expect(diff).toBeUndefined();
     });
 
+    it('diffCRDT keeps the existing value on state ties', function ()
+    {
+        const node = (say: any) => ({
+            'user/said': {
+                '_'  : { '#': 'user/said', '>': { 'say': 1683308843720 } },
+                'say': say
+            }
+        });
+
+        expect(diffCRDT(node('b'), node('a'))).toBeUndefined();
+        expect(diffCRDT(node('a'), node('b'))).toBeUndefined();
+    });
+
+    it('summaries leave out the fields the requester holds', function ()
+    {
+        const node = (fields: {[key: string]: [any, number]}) =>
+        {
+            const result = { _: { '#': 'user/said', '>': {} } };
+            Object.keys(fields).forEach((key) =>
+            {
+                result[key]        = fields[key][0];
+                result._['>'][key] = fields[key][1];
+            });
+            return result;
+        };
+        const local  = node({ b: ['B', 2], a: ['A', 1] });
+        const stored = node({ a: ['A', 1], b: ['B', 2], c: ['C', 3] });
+
+        expect(summarizeNode(local)).toEqual(summarizeNode(node({ a: ['A', 1], b: ['B', 2] })));
+        expect(summarizeNode(local)).not.toEqual(summarizeNode(node({ a: ['A', 1], b: ['b', 2] })));
+        expect(filterGraphBySummary({ 'user/said': stored }, { 'user/said': summarizeNode(local) }))
+            .toEqual({ 'user/said': node({ c: ['C', 3] }) });
+
+        const missed = node({ a: ['A', 1], b: ['B', 2], c: ['C', 3], d: ['D', 1] });
+        expect(filterGraphBySummary({ 'user/said': missed }, { 'user/said': summarizeNode(local) }))
+            .toEqual({ 'user/said': missed });
+
+        client.graph['_graph']['user/said'] = local;
+        expect(client.graph.summarize({ '#': 'user/said' })).toEqual({ 'user/said': summarizeNode(local) });
+        expect(client.graph.summarize({ '#': 'user/other' })).toBeUndefined();
+    });
+
+    it('evicts nodes without listeners beyond the memory budget', async () =>
+    {
+        const node    = (soul: string) => ({ _: { '#': soul, '>': { value: 1 } }, value: 'x'.repeat(50) });
+        const spilled = [];
+
+        client.graph.opt({ memoryBudget: 400, spillTo: { put: ({ graph }) => spilled.push(...Object.keys(graph)) } as any });
+        const off = client.graph.queryMany({ '#': 'item/0' }, () => undefined, 'msg');
+
+        await client.graph.receiveGraphData({ 'item/0': node('item/0') });
+        for (let i = 1; i < 10; i++)
+        {
+            await client.graph.receiveGraphData({ [`item/${i}`]: node(`item/${i}`) });
+        }
+
+        const cached = Object.keys(client.graph['_graph']);
+
+        expect(client.graph.memoryUsage).toBeLessThanOrEqual(400);
+        expect(cached).toContain('item/0');
+        expect(cached).toContain('item/9');
+        expect(cached).not.toContain('item/1');
+        expect(spilled).toContain('item/1');
+        expect(spilled).not.toContain('item/0');
+
+        off();
+        await client.graph.receiveGraphData({ 'item/10': node('item/10') });
+        expect(Object.keys(client.graph['_graph'])).not.toContain('item/0');
+    });
+
+    it('query index matches nodes by soul, prefix and bounds', function ()
+    {
+        const query   = (options: object) => new TGGraphQuery(client.graph, JSON.stringify(options), () => undefined);
+        const chat    = query({ '#': 'chat' });
+        const chatA   = query({ '#': 'chat', '.': { '*': 'a' } });
+        const range   = query({ '#': 'chat', '.': { '>': 'b', '<': 'd' } });
+        const bob     = query({ '#': 'users/bob' });
+        const index   = new TGGraphQueryIndex().add(chat).add(chatA).add(range).add(bob);
+        const node    = (soul: string) => ({ _: { '#': soul, '>': {} } });
+        const matches = (soul: string) =>
+        {
+            const result = [];
+            index.forEachMatch(node(soul), match => result.push(match));
+            return result;
+        };
+
+        expect(matches('chat')).toEqual([chat]);
+        expect(matches('chat/a1')).toEqual([chat, chatA]);
+        expect(matches('chat/b')).toEqual([chat, range]);
+        expect(matches('chat/c')).toEqual([chat, range]);
+        expect(matches('chat/d')).toEqual([chat]);
+        expect(matches('users/bob')).toEqual([bob]);
+        expect(matches('users/al')).toEqual([]);
+        expect(index.hasMatch(node('other'))).toBe(false);
+        expect(index.hasMatch(undefined)).toBe(false);
+
+        index.remove(chat);
+        expect(matches('chat/a1')).toEqual([chatA]);
+        expect(index.hasMatch(node('chat'))).toBe(false);
+        expect(index.hasMatch(node('chat/c'))).toBe(true);
+
+        index.remove(chatA).remove(range).remove(query({ '#': 'chat/x' }));
+        expect(index.hasMatch(node('chat/c'))).toBe(false);
+        expect(index.hasMatch(node('chat/a1'))).toBe(false);
+        expect(index.hasMatch(node('users/bob'))).toBe(true);
+
+        // Emptied branches are pruned
+        expect([...index['_byPrefix'].children.keys()]).toEqual(['u']);
+    });
+
+    it('path queries resolve again from the updated soul', async () =>
+    {
+        const values = [];
+        const node   = (soul: string, key: string, value: any) => ({ _: { '#': soul, '>': { [key]: 1 } }, [key]: value });
+
+        await client.graph.receiveGraphData({
+            'a'  : node('a', 'b', { '#': 'a/b' }),
+            'a/b': node('a/b', 'c', { '#': 'a/c' }),
+            'a/c': node('a/c', 'd', 'first'),
+        });
+
+        const off = client.graph.query(['a', 'b', 'c', 'd'], value => values.push(value), 'msg');
+        expect(values).toEqual(['first']);
+        expect(getPathData(['a', 'b', 'c', 'd'], client.graph['_graph']).souls).toEqual(['a', 'a/b', 'a/c']);
+
+        await client.graph.receiveGraphData({ 'a/c': { _: { '#': 'a/c', '>': { d: 2 } }, d: 'second' } });
+        await wait(10);
+        expect(values).toEqual(['first', 'second']);
+
+        await client.graph.receiveGraphData({
+            'a/b': { _: { '#': 'a/b', '>': { c: 2 } }, c: { '#': 'a/e' } },
+            'a/e': node('a/e', 'd', 'third'),
+        });
+        await wait(10);
+        expect(values).toEqual(['first', 'second', 'third']);
+        expect(Object.keys(client.graph['_queries'])).not.toContain(JSON.stringify({ '#': 'a/c' }));
+
+        off();
+        expect(Object.keys(client.graph['_queries'])).toEqual([]);
+    });
+
+    it('flattens nested objects without recursion', function ()
+    {
+        const data = { name: 'A', b: { name: 'B', c: { name: 'C' } }, d: { name: 'D' } };
+
+        expect(flattenGraphByPath(data, ['a'])).toEqual({
+            'a'    : { name: 'A', b: { '#': 'a/b' }, d: { '#': 'a/d' } },
+            'a/b'  : { name: 'B', c: { '#': 'a/b/c' } },
+            'a/b/c': { name: 'C' },
+            'a/d'  : { name: 'D' },
+        });
+
+        const chunks = [...flattenGraphByPathChunks(data, ['a'], 2)];
+        expect(chunks.map(chunk => Object.keys(chunk))).toEqual([['a/b/c', 'a/b'], ['a/d', 'a']]);
+        expect(Object.assign({}, ...chunks)).toEqual(flattenGraphByPath(data, ['a']));
+
+        const deep = {};
+        let level  = deep;
+        for (let i = 0; i < 3000; i++)
+        {
+            level = level['n'] = {};
+        }
+        expect(Object.keys(flattenGraphByPath(deep, ['deep'])).length).toBe(3001);
+    });
+
     it('callback', async () =>
     {
         const key = 'test';
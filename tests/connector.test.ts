@@ -0,0 +1,261 @@
+import { TGGraphConnectorOptions } from '../src/client/transports/graph-connector';
+import { TGGraphWireConnector } from '../src/client/transports/graph-wire-connector';
+import { TGGraphConnectorFromAdapter } from '../src/client/transports/graph-connector-from-adapter';
+import { TGWorkerGraphConnector } from '../src/client/transports/worker-graph-connector';
+import { TGGraph } from '../src/client/graph/graph';
+import { AsyncStreamEmitter } from 'topgun-async-stream-emitter';
+import { diffCRDT } from '../src/crdt';
+import { TGWorkerHost } from '../src/worker/worker-host';
+import { createMemoryAdapter } from '../src/memory-adapter';
+import { TGGraphData, TGMessage } from '../src/types';
+import { wait } from '../src/utils/wait';
+
+class TestConnector extends TGGraphWireConnector
+{
+    readonly sent: TGMessage[] = [];
+
+    constructor(options?: TGGraphConnectorOptions)
+    {
+        super('TestConnector', options);
+
+        (async () =>
+        {
+            for await (const msg of this.outputQueue.listener('completed'))
+            {
+                this.sent.push(msg);
+            }
+        })();
+    }
+}
+
+function node(soul: string, value: string, state = 1): TGGraphData
+{
+    return { [soul]: { _: { '#': soul, '>': { value: state } }, value } };
+}
+
+describe('Connector', () =>
+{
+    it('coalesces offline puts into one message per reconnect', async () =>
+    {
+        const connector = new TestConnector({ coalesceOfflinePuts: true });
+        const acks      = [];
+
+        connector.put({ graph: node('a', 'A'), msgId: 'first', cb: msg => acks.push(msg['@']) });
+        connector.put({ graph: { ...node('a', 'A2', 2), ...node('b', 'B') }, msgId: 'second', cb: msg => acks.push(msg['@']) });
+        connector.put({ graph: node('b', 'B2', 2), msgId: 'third' });
+        connector.get({ msgId: 'get', options: { '#': 'a' } });
+
+        expect(connector['outputQueue'].count()).toBe(2);
+
+        connector.emit('connect', {});
+        await wait(10);
+
+        expect(connector.sent.map(msg => msg['#'])).toEqual(['first', 'get']);
+        expect(connector.sent[0].put).toEqual({ ...node('a', 'A2', 2), ...node('b', 'B2', 2) });
+
+        connector.ingest([{ '#': 'ack', '@': 'first', ok: true }]);
+        connector.ingest([{ '#': 'ack2', '@': 'first', ok: true }]);
+        await wait(10);
+
+        expect(acks).toEqual(['first', 'second', 'first']);
+    });
+
+    it('emits drain once the queues fall to the low water mark', async () =>
+    {
+        const connector = new TestConnector({ highWaterMark: 3, lowWaterMark: 1 });
+
+        ['a', 'b'].forEach(soul => connector.get({ options: { '#': soul } }));
+        expect(connector.isSaturated).toBe(false);
+
+        connector.get({ options: { '#': 'c' } });
+        expect(connector.isSaturated).toBe(true);
+
+        let drained = false;
+        connector.waitForDrain().then(() => drained = true);
+        await wait(10);
+        expect(drained).toBe(false);
+
+        connector.emit('connect', {});
+        await wait(10);
+
+        expect(connector.sent).toHaveLength(3);
+        expect(drained).toBe(true);
+        expect(connector.isSaturated).toBe(false);
+        await connector.waitForDrain();
+    });
+
+    it('holds writers back while the output queue is saturated', async () =>
+    {
+        let deepest     = 0;
+        const connector = new TestConnector({
+            highWaterMark: 2,
+            lowWaterMark : 0,
+            metrics      : {
+                observe  : () => undefined,
+                increment: () => undefined,
+                gauge    : (_name, value, labels) => labels.queue === 'output' && (deepest = Math.max(deepest, value)),
+            } as any,
+        });
+        const graph     = new TGGraph(new AsyncStreamEmitter());
+        const souls     = Array.from({ length: 20 }, (_, i) => `soul${String(i).padStart(2, '0')}`);
+        let acked       = 0;
+
+        connector.sendPutsFromGraph(graph);
+        graph.connect(connector);
+
+        const writer = (async () =>
+        {
+            for (const soul of souls)
+            {
+                await new Promise(resolve => graph.put(node(soul, soul), resolve));
+                acked++;
+            }
+        })();
+
+        await wait(20);
+
+        // The writer waits on its third put, nothing piles up behind the queue
+        expect(graph.isSaturated).toBe(true);
+        expect(acked).toBe(2);
+        expect(connector['outputQueue'].count()).toBe(2);
+
+        connector.emit('connect', {});
+        await writer;
+        await wait(10);
+
+        expect(deepest).toBeLessThanOrEqual(2);
+        expect(connector.sent.map(msg => Object.keys(msg.put)[0])).toEqual(souls);
+    });
+
+    it('saturates the output queue apart from the input queue', async () =>
+    {
+        const connector = new TestConnector({ highWaterMark: 2, lowWaterMark: 0 });
+
+        connector['inputQueue'].enqueueMany([{ '#': 'a' }, { '#': 'b' }, { '#': 'c' }]);
+        connector.get({ options: { '#': 'a' } });
+
+        expect(connector.isInputSaturated).toBe(true);
+        expect(connector.isSaturated).toBe(false);
+    });
+
+    it('shares a worker hosted graph between tabs', async () =>
+    {
+        const adapter  = createMemoryAdapter();
+        const host     = new TGWorkerHost({ connectors: [new TGGraphConnectorFromAdapter(adapter)] });
+        const channels = [new MessageChannel(), new MessageChannel()];
+        const tabs     = channels.map((channel) =>
+        {
+            const graph     = new TGGraph(new AsyncStreamEmitter());
+            const connector = new TGWorkerGraphConnector(channel.port1 as any);
+
+            host.connect(channel.port2 as any);
+            graph.use(diffCRDT);
+            graph.use(diffCRDT, 'write');
+            connector.sendPutsFromGraph(graph);
+            connector.sendRequestsFromGraph(graph);
+            graph.connect(connector);
+            return { graph, connector };
+        });
+
+        const received = [];
+        const acks     = [];
+        const offChat  = tabs[1].graph.query(['chat'], value => received.push(value), 'chat');
+
+        tabs[0].graph.query(['other'], () => undefined, 'other');
+        await wait(20);
+        tabs[0].graph.put(node('chat', 'Hi'), ack => acks.push(ack.ok));
+        await wait(20);
+
+        expect(received.map(value => value.value)).toEqual(['Hi']);
+        expect(acks).toEqual([true, true]);
+        expect(await adapter.get({ '#': 'chat' })).toEqual(node('chat', 'Hi'));
+
+        offChat();
+        await tabs[1].connector.disconnect();
+        await wait(20);
+
+        expect(host.portCount).toBe(1);
+        expect(Object.keys(host.graph['_queries'])).toEqual([JSON.stringify({ '#': 'other' })]);
+
+        await tabs[0].connector.disconnect();
+        await host.close();
+        channels.forEach(channel => channel.port1.close());
+    });
+
+    it('signs the worker host peers in as one user', async () =>
+    {
+        const logins: string[][] = [];
+        const peer               = new TGGraphConnectorFromAdapter(createMemoryAdapter());
+        const warn               = console.warn;
+        const host               = new TGWorkerHost({ connectors: [peer] });
+        const channels           = [new MessageChannel(), new MessageChannel(), new MessageChannel()];
+        const frames             = [];
+        const tabs               = channels.map((channel) =>
+        {
+            const connector = new TGWorkerGraphConnector(channel.port1 as any, 'TGWorkerGraphConnector', {
+                heartbeatInterval: 0,
+            });
+            let closed      = false;
+
+            host.connect(channel.port2 as any);
+            channel.port2.addEventListener('message', event => frames.push(event.data));
+            connector.listener('disconnect').once().then(() => closed = true);
+            return { connector, isClosed: () => closed };
+        });
+
+        peer.authenticate = async (pub, priv) =>
+        {
+            logins.push([pub, priv]);
+        };
+        console.warn = () => undefined;
+
+        await tabs[0].connector.authenticate('alice', 'alice-priv');
+        await wait(20);
+        expect(tabs[0].isClosed()).toBe(true);
+
+        await host.authenticate('alice', 'host-priv');
+        await tabs[1].connector.authenticate('alice', 'alice-priv');
+        await tabs[2].connector.authenticate('bob', 'bob-priv');
+        await wait(20);
+        console.warn = warn;
+
+        expect(logins).toEqual([['alice', 'host-priv']]);
+        expect(tabs.map(tab => tab.isClosed())).toEqual([true, false, true]);
+        expect(host.portCount).toBe(1);
+        expect(JSON.stringify(frames)).not.toContain('priv');
+
+        await tabs[1].connector.disconnect();
+        await host.close();
+        channels.forEach(channel => channel.port1.close());
+    });
+
+    it('releases the gets of worker ports that went silent', async () =>
+    {
+        const host     = new TGWorkerHost({ connectors: [], portTimeout: 60 });
+        const channels = [new MessageChannel(), new MessageChannel()];
+        const tabs     = channels.map((channel, index) =>
+        {
+            const graph     = new TGGraph(new AsyncStreamEmitter());
+            const connector = new TGWorkerGraphConnector(channel.port1 as any, 'TGWorkerGraphConnector', {
+                heartbeatInterval: index === 0 ? 15 : 0,
+            });
+
+            host.connect(channel.port2 as any);
+            connector.sendRequestsFromGraph(graph);
+            graph.connect(connector);
+            graph.query([`soul${index}`], () => undefined, `soul${index}`);
+            return { graph, connector };
+        });
+
+        await wait(20);
+        expect(Object.keys(host.graph['_queries'])).toHaveLength(2);
+
+        await wait(150);
+        expect(host.portCount).toBe(1);
+        expect(Object.keys(host.graph['_queries'])).toEqual([JSON.stringify({ '#': 'soul0' })]);
+
+        await Promise.all(tabs.map(tab => tab.connector.disconnect()));
+        await host.close();
+        channels.forEach(channel => channel.port1.close());
+    });
+});
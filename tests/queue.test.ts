@@ -0,0 +1,51 @@
+import { TGProcessQueue, TGQueue } from '../src/client';
+
+describe('Queue', () =>
+{
+    it('dequeues unique items in order across growth', () =>
+    {
+        const queue = new TGQueue<number>();
+        const items = Array.from({ length: 100 }, (_, i) => i);
+
+        queue.enqueue(-1).enqueue(-1);
+        queue.dequeue();
+
+        queue.enqueueMany(items.slice(0, 40));
+        expect(queue.dequeue()).toBe(0);
+        queue.enqueueMany(items);
+
+        expect(queue.count()).toBe(100);
+        expect(queue.has(50)).toBe(true);
+
+        const result = [];
+        while (queue.count())
+        {
+            result.push(queue.dequeue());
+        }
+
+        expect(result).toEqual([...items.slice(1, 40), 0, ...items.slice(40)]);
+        expect(queue.has(50)).toBe(false);
+        expect(queue.dequeue()).toBeUndefined();
+    });
+
+    it('skips processed message ids within the dedupe window', async () =>
+    {
+        const queue     = new TGProcessQueue('Queue', 'dont_process_dupes', 2);
+        const completed = [];
+
+        queue.middleware.use((msg) =>
+        {
+            completed.push(msg['#']);
+            return msg;
+        });
+
+        queue.enqueueMany([{ '#': 'a' }, { '#': 'b' }]);
+        await queue.process();
+        queue.enqueueMany([{ '#': 'a' }, { '#': 'c' }]);
+        await queue.process();
+        queue.enqueue({ '#': 'a' });
+        await queue.process();
+
+        expect(completed).toEqual(['a', 'b', 'c', 'a']);
+    });
+});
@@ -14,6 +14,59 @@ describe('SEA', () =>
         await client.disconnect();
     });
 
+    it('sign and verify node fields', async () =>
+    {
+        const pair = await SEA.pair();
+        const soul = `~${pair.pub}/profile`;
+        const node = {
+            _   : { '#': soul, '>': { name: 1, age: 1, bio: 1 } },
+            name: 'Alice',
+            age : 30,
+            bio : 'Hello',
+        };
+
+        const signed = await SEA.signNode(node, pair, 2);
+
+        expect(Object.keys(signed)).toEqual(['_', 'name', 'age', 'bio']);
+        expect(await SEA.verifyNode(signed, pair.pub)).toBe(true);
+        expect(SEA.unpackNode(signed).age).toBe(30);
+        expect(await SEA.verifyNode({ ...signed, age: signed.name }, pair.pub)).toBe(false);
+        expect(await SEA.verifyNode(signed, (await SEA.pair()).pub)).toBe(false);
+        expect(await SEA.verifyNode({ ...signed, bio: 'unsigned' }, pair.pub)).toBe(false);
+    });
+
+    it('unpacks only user souls and reuses unpacked fields', async () =>
+    {
+        const pair  = await SEA.pair();
+        const soul  = `~${pair.pub}/profile`;
+        const plain = { 'chat/1': { _: { '#': 'chat/1', '>': { text: 1 } }, text: '{"a":1}' } };
+
+        expect(SEA.unpackGraph(plain)).toBe(plain);
+
+        const signed = await SEA.signNode({ _: { '#': soul, '>': { info: 1 } }, info: { city: 'Oslo' } }, pair);
+        const first  = SEA.unpackGraph({ ...plain, [soul]: signed });
+        const second = SEA.unpackGraph({ [soul]: { ...signed } });
+
+        expect(first['chat/1']).toBe(plain['chat/1']);
+        expect(first[soul].info).toEqual({ city: 'Oslo' });
+        expect(second[soul].info).toBe(first[soul].info);
+    });
+
+    it('caches one sign key per pub', async () =>
+    {
+        const pair  = await SEA.pair();
+        const other = await SEA.pair();
+        const key   = SEA.importSignKey(pair.pub, pair.priv);
+
+        expect(SEA.importSignKey(pair.pub, pair.priv)).toBe(key);
+        await SEA.importSignKey(pair.pub, other.priv).catch(() => undefined);
+        expect(SEA.importSignKey(pair.pub, pair.priv)).not.toBe(key);
+
+        const reimported = SEA.importSignKey(pair.pub, pair.priv);
+        SEA.clearSignKey(pair.pub);
+        expect(SEA.importSignKey(pair.pub, pair.priv)).not.toBe(reimported);
+    });
+
     it('encrypt/decrypt', async () =>
     {
         const pair       = await SEA.pair();
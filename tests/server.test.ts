@@ -0,0 +1,256 @@
+import { TGSocket } from 'topgun-socket/server';
+import { TGPublishBatcher } from '../src/server/publish-batcher';
+import { TGMuxHub } from '../src/server/mux-hub';
+import { Middleware } from '../src/server/middleware';
+import { createMemoryAdapter } from '../src/memory-adapter';
+import { TGBrokerLink, TGMemoryBroker } from '../src/server/broker';
+import { TG_MUX_EVENT, TGGraphData } from '../src/types';
+import { TGPrometheusMetrics } from '../src/server/prometheus-metrics';
+import { TGWriteScheduler } from '../src/server/write-scheduler';
+import { wait } from '../src/utils/wait';
+
+function createSocket(id: string, channels: string[]): TGSocket & { frames: any[] }
+{
+    const frames = [];
+
+    return {
+        id,
+        frames,
+        isSubscribed: (channel: string) => channels.includes(channel),
+        transmit    : (event: string, data: any) => frames.push({ event, ...data }),
+    } as any;
+}
+
+function diff(soul: string, value: string, state = 1): TGGraphData
+{
+    return { [soul]: { _: { '#': soul, '>': { value: state } }, value } };
+}
+
+describe('Server', () =>
+{
+    it('batches node diffs into one frame per subscriber', async () =>
+    {
+        const batcher = new TGPublishBatcher(0);
+        const first   = createSocket('first', ['topgun/nodes/a', 'topgun/nodes/b']);
+        const second  = createSocket('second', ['topgun/nodes/b']);
+
+        batcher
+            .addSubscriber('a', first)
+            .addSubscriber('b', first)
+            .addSubscriber('b', second)
+            .publish({ ...diff('a', 'A'), ...diff('b', 'B'), ...diff('c', 'C') })
+            .publish(diff('b', 'B2', 2));
+
+        expect(first.frames).toHaveLength(0);
+        await wait(0);
+
+        expect(first.frames).toHaveLength(1);
+        expect(first.frames[0].event).toBe('#publish');
+        expect(first.frames[0].channel).toBe('topgun/nodes/a');
+        expect(first.frames[0].data.put).toEqual({ ...diff('a', 'A'), ...diff('b', 'B2', 2) });
+        expect(second.frames).toHaveLength(1);
+        expect(second.frames[0].data.put).toEqual(diff('b', 'B2', 2));
+    });
+
+    it('drops sockets that left the channel', async () =>
+    {
+        const batcher = new TGPublishBatcher(0);
+        const socket  = createSocket('socket', []);
+
+        batcher.addSubscriber('a', socket).publish(diff('a', 'A'));
+        await wait(0);
+
+        expect(socket.frames).toHaveLength(0);
+        expect(batcher['_subscribers'].size).toBe(0);
+
+        // Leaving the first soul of a frame before the flush keeps the other souls
+        const channels = ['topgun/nodes/a', 'topgun/nodes/b'];
+        const other    = createSocket('other', channels);
+
+        batcher.addSubscriber('a', other).addSubscriber('b', other).publish({ ...diff('a', 'A'), ...diff('b', 'B') });
+        channels.shift();
+        await wait(0);
+
+        expect(other.frames).toHaveLength(1);
+        expect(other.frames[0].channel).toBe('topgun/nodes/b');
+        expect(other.frames[0].data.put).toEqual(diff('b', 'B'));
+        expect([...batcher['_subscribers'].keys()]).toEqual(['b']);
+
+        batcher.removeSocket(other);
+        expect(batcher['_subscribers'].size).toBe(0);
+        expect(batcher['_souls'].size).toBe(0);
+    });
+
+    it('ref-counts multiplexed soul interest per socket', async () =>
+    {
+        const hub    = new TGMuxHub();
+        const socket = createSocket('socket', []);
+
+        hub.subscribe(socket, 'get1', 'a').subscribe(socket, 'get2', 'a').subscribe(socket, 'get2', 'a');
+        hub.publish(diff('a', 'A'), 'm1').publish(diff('a', 'A2', 2), 'm2');
+        await wait(0);
+
+        expect(socket.frames).toHaveLength(1);
+        expect(socket.frames[0].event).toBe(TG_MUX_EVENT);
+        expect(socket.frames[0].msgs.map(msg => msg.put)).toEqual([diff('a', 'A'), diff('a', 'A2', 2)]);
+
+        hub.unsubscribe(socket, 'get1');
+        expect(hub.subscriberCount('a')).toBe(1);
+        hub.unsubscribe(socket, 'get2');
+        expect(hub.subscriberCount('a')).toBe(0);
+
+        hub.subscribe(socket, 'get3', 'a').removeSocket(socket).publish(diff('a', 'A3', 3), 'm3');
+        await wait(0);
+
+        expect(hub.subscriberCount('a')).toBe(0);
+        expect(socket.frames).toHaveLength(1);
+    });
+
+    it('answers multiplexed gets and puts', async () =>
+    {
+        const hub        = new TGMuxHub();
+        const socket     = createSocket('socket', []);
+        const middleware = new Middleware({} as any, {}, createMemoryAdapter(), undefined, hub);
+
+        middleware.processMuxFrame(socket, { msgs: [{ '#': 'put', put: diff('a', 'A') }] });
+        await wait(10);
+        middleware.processMuxFrame(socket, { msgs: [{ '#': 'get', get: { '#': 'a' } }] });
+        await wait(10);
+
+        const msgs = socket.frames.flatMap(frame => frame.msgs);
+
+        expect(msgs).toHaveLength(2);
+        expect(msgs[0]).toEqual(expect.objectContaining({ '@': 'put', ok: true }));
+        expect(msgs[1]).toEqual(expect.objectContaining({ '@': 'get', put: diff('a', 'A') }));
+        expect(hub.subscriberCount('a')).toBe(1);
+
+        middleware.processMuxFrame(socket, { off: ['get'] });
+        expect(hub.subscriberCount('a')).toBe(0);
+    });
+
+    it('streams list replies in pages with continuation cursors', async () =>
+    {
+        const socket     = createSocket('socket', []);
+        const adapter    = createMemoryAdapter();
+        const middleware = new Middleware({} as any, { listPageSize: 2 }, adapter, undefined, new TGMuxHub());
+        const replies    = () => socket.frames.flatMap(frame => frame.msgs);
+
+        await adapter.put({ ...diff('a/1', '1'), ...diff('a/2', '2'), ...diff('a/3', '3'), ...diff('a/4', '4'), ...diff('a/5', '5') });
+
+        middleware.processMuxFrame(socket, { msgs: [{ '#': 'list', get: { '#': 'a', '.': { '*': '' } } }] });
+        await wait(10);
+
+        expect(replies().map(msg => [Object.keys(msg.put), msg['$']])).toEqual([
+            [['a/1', 'a/2'], 'a/2'],
+            [['a/3', 'a/4'], 'a/4'],
+            [['a/5'], undefined],
+        ]);
+        expect(replies().every(msg => msg['@'] === 'list')).toBe(true);
+
+        socket.frames.length = 0;
+        middleware.processMuxFrame(socket, { msgs: [{ '#': 'next', get: { '#': 'a', '.': { '*': '' }, '%': 1, '-': true, '$': 'a/4' } }] });
+        await wait(10);
+
+        expect(replies().map(msg => [Object.keys(msg.put), msg['$']])).toEqual([[['a/3'], 'a/3']]);
+    });
+
+    it('records stage timings and renders them for Prometheus', async () =>
+    {
+        const metrics    = new TGPrometheusMetrics([0.5, 1]);
+        const socket     = createSocket('socket', []);
+        const middleware = new Middleware({} as any, { metrics }, createMemoryAdapter({ metrics }), undefined, new TGMuxHub());
+
+        middleware.processMuxFrame(socket, { msgs: [{ '#': 'put', put: diff('a', 'A') }] });
+        await wait(10);
+        middleware.processMuxFrame(socket, { msgs: [{ '#': 'get', get: { '#': 'a' } }] });
+        await wait(10);
+
+        metrics.increment('topgun_test_total');
+        metrics.gauge('topgun_test_gauge', 2, { name: 'a"b' });
+        metrics.addCollector(() => metrics.gauge('topgun_collected', 1));
+
+        const text = metrics.render();
+
+        expect(text).toContain('# TYPE topgun_storage_seconds histogram');
+        expect(text).toContain('topgun_storage_seconds_count{op="write"} 1');
+        expect(text).toContain('topgun_storage_seconds_bucket{op="read",le="+Inf"} 1');
+        expect(text).toContain('topgun_get_stage_seconds_count{stage="storage"} 1');
+        expect(text).toContain('topgun_test_total 1');
+        expect(text).toContain('topgun_test_gauge{name="a\\"b"} 2');
+        expect(text).toContain('topgun_collected 1');
+
+        metrics.remove('topgun_test_gauge', { name: 'a"b' });
+        expect(metrics.render()).not.toContain('topgun_test_gauge{');
+    });
+
+    it('schedules puts fairly per socket and merges puts to one soul', async () =>
+    {
+        const writes: TGGraphData[] = [];
+        let fail = false;
+        const scheduler = new TGWriteScheduler(async (graph) =>
+        {
+            writes.push(graph);
+            await wait(1);
+
+            if (fail && graph['bad'])
+            {
+                throw new Error('Write failed');
+            }
+        }, { concurrency: 1, maxBatchSize: 2 });
+
+        const bulk = [1, 2, 3, 4, 5].map(i => scheduler.schedule('bulk', diff(`b${i}`, 'B')));
+        const user = scheduler.schedule('user', diff('u', 'U'));
+
+        expect(scheduler.pending).toBe(6);
+        await Promise.all([...bulk, user]);
+        expect(writes.map(graph => Object.keys(graph).join())).toEqual(['b1,b2', 'u', 'b3,b4', 'b5']);
+
+        writes.length = 0;
+        await Promise.all([
+            scheduler.schedule('user', diff('a', 'A2', 2)),
+            scheduler.schedule('user', diff('a', 'A1', 1)),
+        ]);
+        expect(writes).toEqual([diff('a', 'A2', 2)]);
+
+        writes.length = 0;
+        fail          = true;
+        scheduler.schedule('bulk', diff('x', 'X'));
+        const results = await Promise.allSettled([
+            scheduler.schedule('user', diff('c', 'C')),
+            scheduler.schedule('user', diff('bad', 'D')),
+        ]);
+        expect(results.map(result => result.status)).toEqual(['fulfilled', 'rejected']);
+        expect(writes.map(graph => Object.keys(graph).join())).toEqual(['x', 'c,bad', 'c', 'bad']);
+    });
+
+    it('converges servers sharing diffs through a broker', async () =>
+    {
+        const broker   = new TGMemoryBroker();
+        const adapters = [createMemoryAdapter(), createMemoryAdapter(), createMemoryAdapter()];
+        const received = adapters.map(() => []);
+        const links    = adapters.map((adapter, i) => new TGBrokerLink(broker, adapter, msg => received[i].push(msg)));
+        const write    = async (i: number, graph: TGGraphData) =>
+        {
+            const put = await adapters[i].put(graph);
+            links[i].share({ '#': `msg${i}`, put });
+        };
+
+        await Promise.all([
+            write(0, { ...diff('a', 'A'), ...diff('b', 'B') }),
+            write(1, diff('a', 'A2', 2)),
+            write(2, diff('b', 'B0', 0.5)),
+        ]);
+        await wait(10);
+
+        for (const adapter of adapters)
+        {
+            expect(await adapter.get({ '#': 'a' })).toEqual(diff('a', 'A2', 2));
+            expect(await adapter.get({ '#': 'b' })).toEqual(diff('b', 'B'));
+        }
+        expect(received.map(msgs => msgs.map(msg => msg['#']).sort())).toEqual([
+            ['msg1', 'msg2'], ['msg0', 'msg2'], ['msg0', 'msg1'],
+        ]);
+
+        links.forEach(link => link.close());
+    });
+});
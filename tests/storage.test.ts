@@ -0,0 +1,319 @@
+import { mkdtempSync, readdirSync, readFileSync, appendFileSync, rmSync } from 'fs';
+import { tmpdir } from 'os';
+import { join } from 'path';
+import { mergeGraphInPlace } from '../src/crdt';
+import { createFileSystemAdapter, FileSystemStorage } from '../src/fs-adapter';
+import { MemoryStorage } from '../src/memory-adapter';
+import { CachedStorage, createGraphAdapter, createShardedAdapter, StorageListOptions, TGStorage } from '../src/storage';
+import textEncoder from 'topgun-textencoder';
+import { arrayCompare, assertPutEntry, jsonByteLength, lexicographicCompare, listFilterMatch, utf8ByteLength } from '../src/storage/utils';
+import { TGGraphData, TGNode } from '../src/types';
+
+const SOULS = [
+    'chat', 'chat/1', 'chat/10', 'chat/2', 'chat/a', 'chat/b', 'chat/bb',
+    'chat/é', 'chat/\u{1F600}', 'chat/�', 'chatroom', 'config', 'users/a',
+];
+
+function createNode(soul: string): TGNode
+{
+    return { _: { '#': soul, '>': { value: 1 } }, value: soul };
+}
+
+function expectedKeys(options: StorageListOptions): string[]
+{
+    const direction = options.reverse ? -1 : 1;
+    const keys      = SOULS
+        .filter(soul => listFilterMatch(options, soul))
+        .sort((a, b) => direction * lexicographicCompare(a, b));
+
+    return options.limit ? keys.slice(0, options.limit) : keys;
+}
+
+describe('Storage', () =>
+{
+    let storage: MemoryStorage;
+
+    beforeEach(() =>
+    {
+        storage = new MemoryStorage();
+        [...SOULS].reverse().forEach(soul => storage.putSync(soul, createNode(soul)));
+    });
+
+    it('memory storage lists keys in UTF-8 order', async () =>
+    {
+        const allOptions: StorageListOptions[] = [
+            {},
+            { prefix: 'chat/' },
+            { prefix: 'chat/', reverse: true },
+            { prefix: 'chat/', limit: 2 },
+            { prefix: 'chat/', reverse: true, limit: 3 },
+            { prefix: 'chat/', start: 'chat/2' },
+            { prefix: 'chat/', start: 'chat/2', end: 'chat/é' },
+            { prefix: 'chat/', start: 'chat/2', end: 'chat/é', reverse: true, limit: 2 },
+            { prefix: 'chat', end: 'chat/b', reverse: true },
+            { start: 'chatroom', limit: 2 },
+            { prefix: 'missing' },
+        ];
+
+        for (const options of allOptions)
+        {
+            const result = await storage.list({ ...options });
+            expect(Object.keys(result)).toEqual(expectedKeys(options));
+            Object.keys(result).forEach(soul => expect(result[soul]?.value).toBe(soul));
+        }
+    });
+
+    it('compares strings in UTF-8 byte order', () =>
+    {
+        const strings = ['', 'a', 'ab', 'Z', '\u007f', '\u0080', 'é', '\u07ff', '\u0800', '\ud7ff', '\ue000', '\uffff', '\u{10000}', '\u{1F600}', '\u{10FFFF}'];
+
+        for (const x of strings)
+        {
+            for (const y of strings)
+            {
+                const expected = Math.sign(arrayCompare(textEncoder.encode(x + y), textEncoder.encode(y + x)));
+                expect(Math.sign(lexicographicCompare(x + y, y + x))).toBe(expected);
+            }
+        }
+    });
+
+    it('measures serialized sizes in UTF-8 bytes', () =>
+    {
+        const node = {
+            _     : { '#': 'chat/\u{1F600}', '>': { say: 1683308843720, n: 1 } },
+            say   : 'Hé "quoted"\n\u0001\ud800',
+            n     : -12.5,
+            ok    : true,
+            link  : { '#': 'chat/é' },
+            absent: undefined,
+        };
+
+        expect(utf8ByteLength('aé€\u{1F600}\ud800')).toBe(new Blob(['aé€\u{1F600}\ud800']).size);
+        expect(jsonByteLength(node)).toBe(textEncoder.encode(JSON.stringify(node)).length);
+        expect(() => assertPutEntry('é'.repeat(3), node, { maxKeySize: 5 })).toThrow(RangeError);
+        expect(() => assertPutEntry('é'.repeat(3), node, { maxKeySize: 6 })).not.toThrow();
+        expect(() => assertPutEntry('chat', node, { maxValueSize: 100 })).toThrow(RangeError);
+        expect(() => assertPutEntry('chat', node, { maxValueSize: jsonByteLength(node) })).not.toThrow();
+    });
+
+    it('memory storage overwrites existing keys', async () =>
+    {
+        storage.putSync('chat/1', { _: { '#': 'chat/1', '>': { value: 2 } }, value: 'updated' });
+
+        const result = await storage.list({ prefix: 'chat/1' });
+
+        expect(Object.keys(result)).toEqual(['chat/1', 'chat/10']);
+        expect(result['chat/1']?.value).toBe('updated');
+    });
+});
+
+describe('Graph adapter', () =>
+{
+    const graph = () => ({
+        'a'  : { _: { '#': 'a', '>': { b: 1, name: 1 } }, b: { '#': 'a/b' }, name: 'A' },
+        'a/b': { _: { '#': 'a/b', '>': { name: 1 } }, name: 'B' },
+    });
+
+    it('batch storage reads and writes a put once', async () =>
+    {
+        const storage = new MemoryStorage();
+        const calls   = { get: 0, put: 0, getMany: 0, putMany: 0 };
+
+        ['get', 'put', 'getMany', 'putMany'].forEach((method) =>
+        {
+            const original  = storage[method].bind(storage);
+            storage[method] = (...args) =>
+            {
+                calls[method]++;
+                return original(...args);
+            };
+        });
+
+        const adapter = createGraphAdapter(storage);
+        const diff    = await adapter.put(graph());
+
+        expect(Object.keys(diff)).toEqual(['a', 'a/b']);
+        expect(calls).toEqual({ get: 0, put: 0, getMany: 1, putMany: 1 });
+        expect(storage.getSync('a/b')?.name).toBe('B');
+        expect(await adapter.put(graph())).toBeNull();
+        expect(calls.putMany).toBe(1);
+    });
+
+    it('falls back to per node writes without batch methods', async () =>
+    {
+        const memory             = new MemoryStorage();
+        const storage: TGStorage = {
+            get : key => memory.get(key),
+            put : (key, value) => memory.put(key, value),
+            list: options => memory.list(options),
+        };
+        const adapter = createGraphAdapter(storage);
+
+        expect(Object.keys(await adapter.put(graph()))).toEqual(['a', 'a/b']);
+        expect(await adapter.get({ '#': 'a/b' })).toEqual({ 'a/b': graph()['a/b'] });
+    });
+
+    it('merges in place and reports only the changed keys', async () =>
+    {
+        const existing = graph();
+        const node     = existing.a;
+        const changes  = mergeGraphInPlace(existing, {
+            'a'  : { _: { '#': 'a', '>': { name: 2, b: 1 } }, name: 'A2', b: { '#': 'a/b' } },
+            'a/c': { _: { '#': 'a/c', '>': { name: 1 } }, name: 'C' },
+        });
+
+        expect(changes).toEqual({ 'a': ['name'], 'a/c': ['name'] });
+        expect(existing.a).toBe(node);
+        expect(node).toEqual({ _: { '#': 'a', '>': { b: 1, name: 2 } }, b: { '#': 'a/b' }, name: 'A2' });
+        expect(existing['a/c']).toEqual({ _: { '#': 'a/c', '>': { name: 1 } }, name: 'C' });
+        expect(mergeGraphInPlace(existing, graph())).toBeUndefined();
+
+        const adapter = createGraphAdapter(new MemoryStorage());
+        await adapter.put(graph());
+
+        expect(await adapter.put({ a: { _: { '#': 'a', '>': { name: 2, b: 1 } }, name: 'A2', b: { '#': 'a/b' } } }))
+            .toEqual({ a: { _: { '#': 'a', '>': { name: 2 } }, name: 'A2' } });
+    });
+
+    it('sharded adapter spreads souls by range and merges lists', async () =>
+    {
+        const storages = [new MemoryStorage(), new MemoryStorage(), new MemoryStorage()];
+        const adapter  = createShardedAdapter([
+            { start: 'chat/b', adapter: createGraphAdapter(storages[1]) },
+            { adapter: createGraphAdapter(storages[0]) },
+            { start: 'config', adapter: createGraphAdapter(storages[2]) },
+        ]);
+        const input    = SOULS.reduce((graph, soul) => ({ ...graph, [soul]: createNode(soul) }), {});
+
+        expect(Object.keys(await adapter.put(input)).sort()).toEqual([...SOULS].sort());
+        expect(await adapter.put(input)).toBeNull();
+        expect(storages[0].getSync('chat/a')).toBeTruthy();
+        expect(storages[1].getSync('chat/a')).toBeFalsy();
+        expect(storages[1].getSync('chat/é')).toBeTruthy();
+        expect(storages[2].getSync('users/a')).toBeTruthy();
+
+        const single = createGraphAdapter(new MemoryStorage());
+        await single.put(input);
+
+        const queries = [
+            { '#': 'chat' },
+            { '#': 'chat', '.': { '*': 'b' } },
+            { '#': 'chat', '.': { '>': '2', '<': 'c' }, '%': 3 },
+            { '#': 'chat', '%': 4, '-': true },
+            { '#': 'users' },
+        ];
+
+        for (const query of queries)
+        {
+            const expected = await single.get(query);
+            const result   = await adapter.get(query);
+
+            expect(Object.keys(result)).toEqual(Object.keys(expected));
+            expect(result).toEqual(expected);
+        }
+    });
+
+    it('sharded adapter keeps nodes other shards answer null for', async () =>
+    {
+        const found   = createNode('chat/a');
+        const shard   = (graph: TGGraphData) => ({ get: async () => graph, put: async () => null });
+        const adapter = createShardedAdapter([
+            { adapter: shard({ 'chat/a': found, 'chat/z': null }) },
+            { start: 'chat/b', adapter: shard({ 'chat/a': null }) },
+        ]);
+
+        expect(await adapter.get({ '#': 'chat' })).toEqual({ 'chat/a': found, 'chat/z': null });
+    });
+
+    it('read cache serves hot souls and stays coherent with writes', async () =>
+    {
+        const memory  = new MemoryStorage();
+        const calls   = { list: 0, getMany: 0 };
+        const storage = {
+            get    : key => memory.get(key),
+            put    : (key, value) => memory.put(key, value),
+            list   : (options) =>
+            {
+                calls.list++;
+                return memory.list(options);
+            },
+            getMany: (keys) =>
+            {
+                calls.getMany++;
+                return memory.getMany(keys);
+            },
+            putMany: data => memory.putMany(data),
+        };
+        const adapter = createGraphAdapter(storage, { readCacheSize: 10000 });
+
+        await adapter.put(graph());
+        expect(await adapter.get({ '#': 'a' })).toEqual(graph());
+        expect(await adapter.get({ '#': 'a' })).toEqual(graph());
+        expect(calls).toEqual({ list: 1, getMany: 1 });
+
+        await adapter.put({ 'a/b': { _: { '#': 'a/b', '>': { name: 2 } }, name: 'B2' } });
+        expect(calls.getMany).toBe(1);
+        expect((await adapter.get({ '#': 'a' }))['a/b'].name).toBe('B2');
+        expect(calls.list).toBe(1);
+
+        await adapter.put({ 'a/c': { _: { '#': 'a/c', '>': { name: 1 } }, name: 'C' } });
+        expect(Object.keys(await adapter.get({ '#': 'a' }))).toEqual(['a', 'a/b', 'a/c']);
+        expect(calls.list).toBe(2);
+        expect(adapter.cacheStats()).toEqual(expect.objectContaining({ hits: 3, misses: 5, evictions: 0 }));
+
+        const small = new CachedStorage(memory, 150);
+        await small.get('a');
+        await small.get('a/b');
+        await small.get('a/c');
+
+        expect(small.stats().bytes).toBeLessThan(151);
+        expect(small.stats().evictions).toBeGreaterThan(0);
+        expect(await small.get('a/c')).toBe(memory.getSync('a/c'));
+    });
+
+    it('file system storage restores writes after reopening', async () =>
+    {
+        const directory = mkdtempSync(join(tmpdir(), 'topgun-'));
+
+        try
+        {
+            const first   = new FileSystemStorage(directory, { compactThreshold: Infinity });
+            const adapter = createGraphAdapter(first);
+
+            await adapter.put(graph());
+            await first.compact();
+            await adapter.put({ 'a/b': { _: { '#': 'a/b', '>': { name: 2 } }, name: 'B2' } });
+            await first.close();
+
+            expect(readdirSync(directory).sort()).toEqual(['log-000001.jsonl', 'snapshot.jsonl']);
+
+            // A record torn by a crash is skipped
+            appendFileSync(join(directory, 'log-000001.jsonl'), '{"a/c":{"_":');
+
+            const second = createFileSystemAdapter(directory);
+            const result = await second.get({ '#': 'a' });
+
+            expect(Object.keys(result)).toEqual(['a', 'a/b']);
+            expect(result['a/b'].name).toBe('B2');
+
+            // Writes after the torn record survive the next restart, only the diff is logged
+            await second.put({ 'a/b': { _: { '#': 'a/b', '>': { age: 3 } }, age: 30 } });
+            await second.close();
+
+            expect(readFileSync(join(directory, 'log-000001.jsonl'), 'utf8')).toContain(
+                '{"a/b":{"_":{"#":"a/b",">":{"age":3}},"age":30}}\n',
+            );
+
+            const third = createFileSystemAdapter(directory);
+            const node  = (await third.get({ '#': 'a/b' }))['a/b'];
+
+            expect(node.name).toBe('B2');
+            expect(node.age).toBe(30);
+            await third.close();
+        }
+        finally
+        {
+            rmSync(directory, { recursive: true, force: true });
+        }
+    });
+});
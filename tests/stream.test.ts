@@ -122,4 +122,75 @@ describe('Stream', () =>
 
         expect(receivedPackets.length).toBe(27);
     });
-});
\ No newline at end of file
+
+    it('delivers to direct handlers synchronously or once per microtask', async () =>
+    {
+        const exchange = new TGExchange();
+        const stream   = exchange.subscribe();
+        const sync     = [];
+        const batched  = [];
+
+        stream.listen(packet => sync.push(packet));
+        const off = stream.listen(packet => batched.push(packet), 'microtask');
+
+        exchange.publish(stream.name, 1);
+        exchange.publish(stream.name, 2);
+        expect(sync).toEqual([1, 2]);
+        expect(batched).toEqual([]);
+
+        await Promise.resolve();
+        expect(batched).toEqual([1, 2]);
+
+        stream.unsubscribe();
+        exchange.publish(stream.name, 3);
+        stream.subscribe();
+        off();
+        exchange.publish(stream.name, 4);
+        await Promise.resolve();
+        expect(sync).toEqual([1, 2, 4]);
+        expect(batched).toEqual([1, 2]);
+
+        stream.destroy();
+        exchange.publish(stream.name, 5);
+        expect(sync).toEqual([1, 2, 4]);
+    });
+
+    it('keeps delivering when a direct handler throws', async () =>
+    {
+        const exchange = new TGExchange();
+        const stream   = exchange.subscribe();
+        const sync     = [];
+        const batched  = [];
+        const listened = [];
+        const warn     = console.warn;
+        const fail     = () =>
+        {
+            throw new Error('handler failed');
+        };
+
+        console.warn = () => undefined;
+        (async () =>
+        {
+            for await (const packet of stream)
+            {
+                listened.push(packet);
+            }
+        })();
+
+        stream.listen(fail);
+        stream.listen(packet => sync.push(packet));
+        stream.listen(fail, 'microtask');
+        stream.listen(packet => batched.push(packet), 'microtask');
+
+        exchange.publish(stream.name, 1);
+        exchange.publish(stream.name, 2);
+        expect(sync).toEqual([1, 2]);
+
+        await wait(10);
+        console.warn = warn;
+        expect(batched).toEqual([1, 2]);
+        expect(listened).toEqual([1, 2]);
+
+        stream.destroy();
+    });
+});
@@ -1,7 +1,8 @@
 import { expectErr, expectOk } from './test-util';
-import { createValidator } from '../src/validator';
+import { createFastValidator, createValidator } from '../src/validator';
+import { createSeaValidator } from '../src/validator-sea';
+import * as SEA from '../src/sea';
 
-const validator = createValidator();
 const getTopGunData = () => ({
     user: {
         _: {
@@ -18,7 +19,10 @@ const getTopGunData = () => ({
     },
 });
 
-describe('Graph format', () => {
+describe.each([
+    ['struct', createValidator()],
+    ['fast', createFastValidator()],
+])('Graph format (%s)', (_name, validator) => {
     it('Valid graph data', () => {
         const graph = getTopGunData();
         const result = validator(graph);
@@ -84,4 +88,60 @@ describe('Graph format', () => {
             `Node state must be object in path _.['>']`,
         );
     });
+
+    it('Node values and states', () => {
+        const graphs = [
+            { ...getTopGunData(), extra: undefined },
+            (() => { const g = getTopGunData(); g.user.name = [1] as any; return g; })(),
+            (() => { const g = getTopGunData(); g.user.name = NaN as any; return g; })(),
+            (() => { const g = getTopGunData(); g.user.said = { '#': 'user/said', x: 1 } as any; return g; })(),
+            (() => { const g = getTopGunData(); g.user._['>'].name = '1' as any; return g; })(),
+            (() => { const g = getTopGunData(); delete g.user._['>'].email; return g; })(),
+            (() => { const g = getTopGunData(); g.user._['>']['other'] = 1; return g; })(),
+            (() => { const g = getTopGunData(); g.user.name = null; return g; })(),
+        ];
+
+        graphs.forEach(graph => expect(validator(graph)).toEqual(createValidator()(graph)));
+    });
+});
+
+describe('SEA signatures', () => {
+    const createGraph = async () => {
+        const pair = await SEA.pair();
+        const soul = `~${pair.pub}/profile`;
+        const node = await SEA.signNode({
+            _: { '#': soul, '>': { name: 1682701808609, age: 1682701808609 } },
+            name: 'Mark',
+            age: 30,
+        }, pair);
+
+        return { pair, soul, graph: { [soul]: node } };
+    };
+
+    [0, 1].forEach((workers) => {
+        it(`Signed user graph with ${workers} workers`, async () => {
+            const seaValidator = createSeaValidator({ workers });
+            const { soul, graph } = await createGraph();
+
+            expectOk(await seaValidator.validate(graph), graph);
+            expectOk(await seaValidator.validate({ public: getTopGunData().user }), { public: getTopGunData().user });
+
+            const tampered = { [soul]: { ...graph[soul], age: graph[soul].name } };
+            expectErr(await seaValidator.validate(tampered), 'Invalid signature', { path: [soul, 'age'] });
+
+            const unsigned = { [soul]: { ...graph[soul], age: 31 } };
+            expectErr(await seaValidator.validate(unsigned), 'Signature is missing', { path: [soul, 'age'] });
+
+            await seaValidator.close();
+        });
+    });
+
+    it('Signature of another user', async () => {
+        const seaValidator = createSeaValidator({ workers: 0 });
+        const { soul, graph } = await createGraph();
+        const other = await createGraph();
+
+        const forged = { [soul]: { ...other.graph[other.soul], _: graph[soul]._ } };
+        expectErr(await seaValidator.validate(forged), 'Invalid signature');
+    });
 });
@@ -1,7 +1,7 @@
 const fs = require('fs');
 const path = require('path');
 
-const PACKAGE_DIRS = ['client', 'server', 'stream', 'sea'];
+const PACKAGE_DIRS = ['client', 'server', 'stream', 'sea', 'worker'];
 
 const getContent = function (name)
 {